@@ -14,6 +14,7 @@ namespace {
 Camera::Camera() 
     : position(0.0f, 0.0f)
     , zoomLevel(DEFAULT_ZOOM)
+    , minZoom(MIN_ZOOM)
 {
 }
 
@@ -28,7 +29,12 @@ void Camera::moveTo(float x, float y) {
 }
 
 void Camera::zoom(float delta) {
-    zoomLevel = clamp(zoomLevel + delta, MIN_ZOOM, MAX_ZOOM);
+    zoomLevel = clamp(zoomLevel + delta, minZoom, MAX_ZOOM);
+}
+
+void Camera::setMinZoom(float zoom) {
+    minZoom = clamp(zoom, MIN_ZOOM, MAX_ZOOM);
+    zoomLevel = clamp(zoomLevel, minZoom, MAX_ZOOM);
 }
 
 Vec2 Camera::screenToWorld(const Vec2& screenPos) const {
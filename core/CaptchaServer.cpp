@@ -4,6 +4,7 @@
 #include <boost/beast/http.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <thread>
+#include <atomic>
 
 namespace owop {
 
@@ -14,7 +15,7 @@ using tcp = boost::asio::ip::tcp;
 
 class CaptchaServer::Impl {
 public:
-    bool running{false};
+    std::atomic<bool> running{false};  // Exchanged so a second start() or stop() is a no-op
     
     Impl(uint16_t port, CaptchaCallback callback)
         : port(port)
@@ -26,14 +27,17 @@ public:
         Logger::info("CaptchaServer", "Created on port " + std::to_string(port));
     }
 
+    ~Impl() {
+        stop();  // No-op if the session already stopped us
+    }
+
     void start() {
-        if (running) {
+        if (running.exchange(true)) {
             Logger::info("CaptchaServer", "Server already running");
             return;
         }
 
         Logger::info("CaptchaServer", "Starting server...");
-        running = true;
 
         try {
             // Create and configure the acceptor
@@ -88,10 +92,9 @@ public:
     }
 
     void stop() {
-        if (!running) return;
+        if (!running.exchange(false)) return;
 
         Logger::info("CaptchaServer", "Stopping server...");
-        running = false;
 
         try {
             // Close the acceptor to interrupt any pending accept operations
@@ -0,0 +1,180 @@
+#include "ChunkScheduler.hpp"
+#include <algorithm>
+
+namespace owop {
+
+bool ChunkScheduler::enqueue(const ChunkCoord& coord) {
+    auto result = entries.emplace(coord, Entry{State::Queued, 0, Clock::time_point(), Clock::time_point()});
+    if (!result.second) {
+        return false;  // Already queued, pending or loaded
+    }
+
+    heap.push_back(QueueItem{distanceTo(coord), coord});
+    std::push_heap(heap.begin(), heap.end());
+    return true;
+}
+
+size_t ChunkScheduler::setView(int32_t chunkX, int32_t chunkY, const ChunkRect& area) {
+    if (chunkX == centerX && chunkY == centerY && area == keepArea) {
+        return 0;
+    }
+
+    centerX = chunkX;
+    centerY = chunkY;
+    keepArea = area;
+
+    // Drop requests that left the view and re-score the rest in the same pass
+    size_t kept = 0;
+    for (size_t i = 0; i < heap.size(); i++) {
+        QueueItem item = heap[i];
+        if (!keepArea.contains(item.coord)) {
+            entries.erase(item.coord);
+            continue;
+        }
+        item.priority = distanceTo(item.coord);
+        heap[kept++] = item;
+    }
+
+    size_t dropped = heap.size() - kept;
+    heap.resize(kept);
+    std::make_heap(heap.begin(), heap.end());
+
+    cancelled += dropped;
+    return dropped;
+}
+
+bool ChunkScheduler::popNext(ChunkCoord& coord, Clock::time_point now, Clock::duration timeout) {
+    if (heap.empty()) {
+        return false;
+    }
+
+    std::pop_heap(heap.begin(), heap.end());
+    coord = heap.back().coord;
+    heap.pop_back();
+
+    Entry& entry = entries[coord];
+    entry.state = State::Pending;
+    entry.attempts++;
+    entry.sentAt = now;
+    entry.deadline = now + timeout;
+    pending.insert(coord);
+    return true;
+}
+
+size_t ChunkScheduler::expire(Clock::time_point now, Clock::duration backoffBase, int maxAttempts) {
+    size_t expired = 0;
+
+    // Overdue requests either wait out a backoff or are given up on
+    for (auto it = pending.begin(); it != pending.end();) {
+        Entry& entry = entries[*it];
+        if (entry.deadline > now) {
+            ++it;
+            continue;
+        }
+
+        expired++;
+        timeouts++;
+        if (entry.attempts >= maxAttempts) {
+            entry.state = State::Abandoned;
+            abandoned++;
+        } else {
+            entry.state = State::Backoff;
+            entry.deadline = now + backoffBase * (1 << (entry.attempts - 1));
+            backoff.push_back(*it);
+        }
+        it = pending.erase(it);
+    }
+
+    // Re-queue retries whose backoff has elapsed, unless they left the view meanwhile
+    for (size_t i = 0; i < backoff.size();) {
+        const ChunkCoord coord = backoff[i];
+        auto it = entries.find(coord);
+        bool stale = it == entries.end() || it->second.state != State::Backoff;
+        if (!stale && it->second.deadline > now) {
+            i++;
+            continue;
+        }
+
+        if (!stale) {
+            if (keepArea.contains(coord)) {
+                it->second.state = State::Queued;
+                heap.push_back(QueueItem{distanceTo(coord), coord});
+                std::push_heap(heap.begin(), heap.end());
+                retries++;
+            } else {
+                entries.erase(it);
+                cancelled++;
+            }
+        }
+
+        backoff[i] = backoff.back();
+        backoff.pop_back();
+    }
+
+    return expired;
+}
+
+bool ChunkScheduler::markLoaded(const ChunkCoord& coord, Clock::time_point& sentAt) {
+    auto it = entries.find(coord);
+    if (it == entries.end()) {
+        // Unsolicited chunk - remember it so it isn't requested again
+        entries.emplace(coord, Entry{State::Loaded, 0, Clock::time_point(), Clock::time_point()});
+        return false;
+    }
+
+    bool wasPending = it->second.state == State::Pending;
+    if (wasPending) {
+        sentAt = it->second.sentAt;
+        pending.erase(coord);
+    } else if (it->second.state == State::Queued) {
+        // Arrived before we asked; drop it from the queue
+        heap.erase(std::remove_if(heap.begin(), heap.end(),
+            [&coord](const QueueItem& item) { return item.coord == coord; }), heap.end());
+        std::make_heap(heap.begin(), heap.end());
+    }
+    // Late responses for Backoff entries are simply accepted; the stale
+    // backoff list slot is skipped by expire()
+
+    it->second.state = State::Loaded;
+    return wasPending;
+}
+
+void ChunkScheduler::markFailed(const ChunkCoord& coord) {
+    auto it = entries.find(coord);
+    if (it == entries.end() || it->second.state != State::Pending) {
+        return;
+    }
+
+    entries.erase(it);
+    pending.erase(coord);
+}
+
+void ChunkScheduler::forget(const ChunkCoord& coord) {
+    auto it = entries.find(coord);
+    if (it == entries.end()) {
+        return;
+    }
+
+    if (it->second.state == State::Pending) {
+        pending.erase(coord);
+    } else if (it->second.state == State::Queued) {
+        heap.erase(std::remove_if(heap.begin(), heap.end(),
+            [&coord](const QueueItem& item) { return item.coord == coord; }), heap.end());
+        std::make_heap(heap.begin(), heap.end());
+    }
+    // Backoff entries leave a stale slot in the backoff list that expire() skips
+
+    entries.erase(it);
+}
+
+void ChunkScheduler::clear() {
+    entries.clear();
+    heap.clear();
+    pending.clear();
+    backoff.clear();
+    centerX = 0;
+    centerY = 0;
+    keepArea = ChunkRect{INT32_MIN, INT32_MIN, INT32_MAX, INT32_MAX};
+}
+
+} // namespace owop
@@ -0,0 +1,144 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <climits>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace owop {
+
+// Helper struct for chunk coordinates
+struct ChunkCoord {
+    int32_t x;
+    int32_t y;
+
+    bool operator==(const ChunkCoord& other) const {
+        return x == other.x && y == other.y;
+    }
+
+    bool operator<(const ChunkCoord& other) const {
+        return x < other.x || (x == other.x && y < other.y);
+    }
+};
+
+struct ChunkCoordHash {
+    size_t operator()(const ChunkCoord& coord) const {
+        uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(coord.x)) << 32) | static_cast<uint32_t>(coord.y);
+        return std::hash<uint64_t>()(key);
+    }
+};
+
+// Inclusive rectangle in chunk coordinates
+struct ChunkRect {
+    int32_t minX;
+    int32_t minY;
+    int32_t maxX;
+    int32_t maxY;
+
+    bool contains(const ChunkCoord& coord) const {
+        return coord.x >= minX && coord.x <= maxX && coord.y >= minY && coord.y <= maxY;
+    }
+
+    bool operator==(const ChunkRect& other) const {
+        return minX == other.minX && minY == other.minY && maxX == other.maxX && maxY == other.maxY;
+    }
+};
+
+// Tracks every chunk the client knows about (queued, requested or loaded) in a
+// single hash map so duplicate requests are rejected in O(1), and keeps the
+// queued ones in a binary heap ordered by distance to the view center.
+// Requests carry a deadline; expire() moves overdue ones into a backoff list and
+// re-queues them when the backoff has elapsed, up to a maximum attempt count.
+// Not thread-safe: NetworkImpl only uses it on the websocket thread.
+class ChunkScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Queue a chunk unless it is already queued, pending or loaded
+    bool enqueue(const ChunkCoord& coord);
+
+    // Move the view center and drop queued chunks outside keepArea. Re-prioritizes
+    // the whole queue in one O(n) pass and returns how many requests were cancelled.
+    size_t setView(int32_t chunkX, int32_t chunkY, const ChunkRect& keepArea);
+
+    // Take the queued chunk nearest the center and mark it pending until now + timeout
+    bool popNext(ChunkCoord& coord, Clock::time_point now, Clock::duration timeout);
+
+    // Handle overdue requests and re-queue retries whose backoff has elapsed.
+    // Returns the number of requests that timed out during this call.
+    size_t expire(Clock::time_point now, Clock::duration backoff, int maxAttempts);
+
+    // Mark a chunk as loaded. Returns true and the send time if it was pending.
+    bool markLoaded(const ChunkCoord& coord, Clock::time_point& sentAt);
+
+    // Forget a pending request so the chunk can be queued again
+    void markFailed(const ChunkCoord& coord);
+
+    // Forget a chunk in any state so it can be queued again
+    void forget(const ChunkCoord& coord);
+
+    // Drop every queued, pending and loaded chunk. The counters below keep
+    // counting across clears, so they cover the whole session.
+    void clear();
+
+    bool isKnown(const ChunkCoord& coord) const { return entries.find(coord) != entries.end(); }
+    bool isLoaded(const ChunkCoord& coord) const {
+        auto it = entries.find(coord);
+        return it != entries.end() && it->second.state == State::Loaded;
+    }
+    size_t queuedCount() const { return heap.size(); }
+    size_t pendingCount() const { return pending.size(); }
+    uint64_t cancelledCount() const { return cancelled; }
+    uint64_t timeoutCount() const { return timeouts; }
+    uint64_t retryCount() const { return retries; }
+    uint64_t abandonedCount() const { return abandoned; }
+
+private:
+    enum class State : uint8_t {
+        Queued,
+        Pending,
+        Backoff,    // Timed out, waiting to be re-queued
+        Abandoned,  // Gave up after maxAttempts; not requested again until clear()
+        Loaded
+    };
+
+    struct Entry {
+        State state;
+        uint8_t attempts;
+        Clock::time_point sentAt;
+        Clock::time_point deadline;  // Response due by (Pending) or retry at (Backoff)
+    };
+
+    struct QueueItem {
+        int64_t priority;  // Squared distance to the center, lower is served first
+        ChunkCoord coord;
+
+        bool operator<(const QueueItem& other) const {
+            // std::*_heap builds a max-heap; invert so the nearest chunk is on top
+            return priority > other.priority;
+        }
+    };
+
+    int64_t distanceTo(const ChunkCoord& coord) const {
+        int64_t dx = static_cast<int64_t>(coord.x) - centerX;
+        int64_t dy = static_cast<int64_t>(coord.y) - centerY;
+        return dx * dx + dy * dy;
+    }
+
+    std::unordered_map<ChunkCoord, Entry, ChunkCoordHash> entries;
+    std::vector<QueueItem> heap;
+    std::unordered_set<ChunkCoord, ChunkCoordHash> pending;  // Bounded by the request window
+    std::vector<ChunkCoord> backoff;
+    uint64_t cancelled{0};
+    uint64_t timeouts{0};
+    uint64_t retries{0};
+    uint64_t abandoned{0};
+    int32_t centerX{0};
+    int32_t centerY{0};
+    ChunkRect keepArea{INT32_MIN, INT32_MIN, INT32_MAX, INT32_MAX};
+};
+
+} // namespace owop
@@ -0,0 +1,104 @@
+#include "ChunkWindow.hpp"
+#include <owop-client/Constants.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace owop {
+
+namespace {
+    double toMs(ChunkWindow::Clock::duration d) {
+        return std::chrono::duration<double, std::milli>(d).count();
+    }
+}
+
+ChunkWindow::ChunkWindow(size_t maxWindow)
+    : window(CHUNK_WINDOW_INITIAL)
+    , slowStartThreshold(static_cast<double>(maxWindow))
+    , maxWindow(std::max<size_t>(maxWindow, CHUNK_WINDOW_MIN))
+{
+}
+
+void ChunkWindow::reset() {
+    window = std::min<double>(CHUNK_WINDOW_INITIAL, static_cast<double>(maxWindow));
+    slowStartThreshold = static_cast<double>(maxWindow);
+    smoothedRttMs = 0.0;
+    minRttMs = 0.0;
+    lastDecrease = Clock::time_point();
+    rateWindowStart = Clock::time_point();
+    rateWindowCount = 0;
+    arrivalRate = 0.0;
+}
+
+void ChunkWindow::setMaxWindow(size_t value) {
+    maxWindow = std::max<size_t>(value, CHUNK_WINDOW_MIN);
+    window = std::min(window, static_cast<double>(maxWindow));
+    slowStartThreshold = std::min(slowStartThreshold, static_cast<double>(maxWindow));
+}
+
+void ChunkWindow::onResponse(Clock::duration rtt, Clock::time_point now, bool appLimited) {
+    double sample = toMs(rtt);
+    smoothedRttMs = smoothedRttMs == 0.0 ? sample : smoothedRttMs * 0.875 + sample * 0.125;
+    minRttMs = minRttMs == 0.0 ? sample : std::min(minRttMs, sample);
+
+    updateArrivalRate(now, appLimited);
+
+    if (sample > minRttMs * CHUNK_RTT_INFLATION) {
+        // Responses are queueing somewhere - back off
+        decrease(now);
+    } else if (window < slowStartThreshold) {
+        window += 1.0;           // Slow start: doubles every RTT
+    } else {
+        window += 1.0 / window;  // Congestion avoidance: +1 every RTT
+    }
+
+    // Don't run more than two bandwidth-delay products ahead of the measured arrival rate
+    if (arrivalRate > 0.0) {
+        double bdp = arrivalRate * (minRttMs / 1000.0);
+        window = std::min(window, std::max(2.0 * bdp, static_cast<double>(CHUNK_WINDOW_INITIAL)));
+    }
+
+    window = std::clamp(window, static_cast<double>(CHUNK_WINDOW_MIN), static_cast<double>(maxWindow));
+}
+
+void ChunkWindow::onLoss(Clock::time_point now) {
+    decrease(now);
+}
+
+void ChunkWindow::decrease(Clock::time_point now) {
+    // At most one multiplicative decrease per smoothed RTT
+    auto sinceLast = std::chrono::duration<double, std::milli>(now - lastDecrease).count();
+    if (lastDecrease != Clock::time_point() && sinceLast < smoothedRttMs) {
+        return;
+    }
+
+    window = std::max(window * 0.5, static_cast<double>(CHUNK_WINDOW_MIN));
+    slowStartThreshold = window;
+    lastDecrease = now;
+}
+
+void ChunkWindow::updateArrivalRate(Clock::time_point now, bool appLimited) {
+    // Drop the sample and start over with the next busy response, so neither a
+    // trickling tail nor the idle gap before the next sweep counts as a slow link
+    if (appLimited) {
+        rateWindowCount = 0;
+        return;
+    }
+
+    if (rateWindowCount == 0) {
+        rateWindowStart = now;
+    }
+    rateWindowCount++;
+
+    double elapsed = std::chrono::duration<double>(now - rateWindowStart).count();
+    if (elapsed >= 0.25) {
+        double instant = rateWindowCount / elapsed;
+        arrivalRate = arrivalRate == 0.0 ? instant : arrivalRate * 0.75 + instant * 0.25;
+        rateWindowCount = 0;
+    }
+}
+
+size_t ChunkWindow::size() const {
+    return static_cast<size_t>(std::floor(window));
+}
+
+} // namespace owop
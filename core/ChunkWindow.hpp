@@ -0,0 +1,50 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+
+namespace owop {
+
+// AIMD controller for the number of concurrently outstanding chunk requests.
+// Grows like TCP slow start / congestion avoidance while the measured RTT stays
+// close to the minimum, halves once per RTT when responses start queueing up,
+// and never runs far ahead of what the measured arrival rate can sustain.
+// Not thread-safe: NetworkImpl only uses it on the websocket thread.
+class ChunkWindow {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit ChunkWindow(size_t maxWindow);
+
+    void reset();
+    void setMaxWindow(size_t value);
+
+    // Called for every chunk response that matches an outstanding request.
+    // appLimited means nothing was queued behind the window, so the arrival
+    // rate reflects the view running out of chunks rather than the link.
+    void onResponse(Clock::duration rtt, Clock::time_point now, bool appLimited);
+    // Called when a request is considered lost
+    void onLoss(Clock::time_point now);
+
+    size_t size() const;
+    double getSmoothedRttMs() const { return smoothedRttMs; }
+    double getMinRttMs() const { return minRttMs; }
+    double getArrivalRate() const { return arrivalRate; }
+
+private:
+    void decrease(Clock::time_point now);
+    void updateArrivalRate(Clock::time_point now, bool appLimited);
+
+    double window;
+    double slowStartThreshold;
+    size_t maxWindow;
+
+    double smoothedRttMs{0.0};
+    double minRttMs{0.0};
+    Clock::time_point lastDecrease;
+
+    Clock::time_point rateWindowStart;
+    size_t rateWindowCount{0};
+    double arrivalRate{0.0};  // Chunks per second, smoothed
+};
+
+} // namespace owop
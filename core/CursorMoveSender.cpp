@@ -0,0 +1,39 @@
+#include "CursorMoveSender.hpp"
+#include <owop-client/Constants.hpp>
+
+namespace owop {
+
+const protocol::MoveLayout::Buffer* CursorMoveSender::sample(int32_t x, int32_t y, const Color& color, uint8_t tool,
+                                                             Clock::time_point now) {
+    State state{floorDiv(x, PLAYER_POSITION_SCALE), floorDiv(y, PLAYER_POSITION_SCALE), color, tool};
+
+    // Back where we last were: nothing new to tell
+    if (hasSent && state == lastSent) {
+        hasWaiting = false;
+        return nullptr;
+    }
+
+    if (hasSent && now - lastSentAt < std::chrono::milliseconds(PLAYER_MOVE_INTERVAL_MS)) {
+        if (hasWaiting && state != waiting) {
+            coalesced++;
+        }
+        waiting = state;
+        hasWaiting = true;
+        return nullptr;
+    }
+
+    protocol::MoveLayout::encodeInto(buffer, x, y, color.r, color.g, color.b, tool);
+    lastSent = state;
+    lastSentAt = now;
+    hasSent = true;
+    hasWaiting = false;
+    sent++;
+    return &buffer;
+}
+
+void CursorMoveSender::reset() {
+    hasSent = false;
+    hasWaiting = false;
+}
+
+} // namespace owop
@@ -0,0 +1,55 @@
+#pragma once
+#include <owop-client/Protocol.hpp>
+#include <owop-client/Types.hpp>
+#include <chrono>
+#include <cstdint>
+
+namespace owop {
+
+// Decides when our cursor is worth telling the server about. The cursor is
+// sampled every frame, but a Move only goes out when it is on a different
+// pixel (or shows a different color or tool) than the last one sent, and at
+// most once per PLAYER_MOVE_INTERVAL_MS - one server tick. Positions sampled
+// in between collapse into the next send. The message is encoded into one
+// buffer that lives as long as the sender.
+// Not thread-safe: used from the main thread only.
+class CursorMoveSender {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Record the latest cursor state (x, y in 1/16 pixel units). Returns the
+    // encoded Move if one is due now, nullptr otherwise.
+    const protocol::MoveLayout::Buffer* sample(int32_t x, int32_t y, const Color& color, uint8_t tool,
+                                               Clock::time_point now);
+
+    // Forget what was sent, so the next sample goes out (after joining a world)
+    void reset();
+
+    uint64_t sentCount() const { return sent; }
+    uint64_t coalescedCount() const { return coalesced; }
+
+private:
+    struct State {
+        int32_t tileX;
+        int32_t tileY;
+        Color color;
+        uint8_t tool;
+
+        bool operator==(const State& other) const {
+            return tileX == other.tileX && tileY == other.tileY && tool == other.tool &&
+                color.r == other.color.r && color.g == other.color.g && color.b == other.color.b;
+        }
+        bool operator!=(const State& other) const { return !(*this == other); }
+    };
+
+    protocol::MoveLayout::Buffer buffer{};
+    State lastSent{};
+    State waiting{};            // Newest unsent state, valid while hasWaiting
+    bool hasSent{false};
+    bool hasWaiting{false};
+    Clock::time_point lastSentAt{};
+    uint64_t sent{0};
+    uint64_t coalesced{0};      // Unsent states replaced by a newer one before their turn
+};
+
+} // namespace owop
@@ -0,0 +1,43 @@
+#include "FrameQueue.hpp"
+#include <cstring>
+
+namespace owop {
+
+void FrameQueue::push(const void* data, size_t length, bool text, Clock::time_point now) {
+    // Reclaim the consumed front once it is at least half the buffer
+    if (consumedBytes > 0 && consumedBytes * 2 >= payload.size()) {
+        compact();
+    }
+
+    size_t offset = payload.size();
+    payload.resize(offset + length);
+    std::memcpy(payload.data() + offset, data, length);
+    frames.push_back(Frame{offset, length, text, now});
+}
+
+void FrameQueue::popFront() {
+    consumedBytes += frames[head].length;
+    head++;
+    if (head == frames.size()) {
+        clear();
+    }
+}
+
+void FrameQueue::clear() {
+    payload.clear();
+    frames.clear();
+    head = 0;
+    consumedBytes = 0;
+}
+
+void FrameQueue::compact() {
+    payload.erase(payload.begin(), payload.begin() + consumedBytes);
+    frames.erase(frames.begin(), frames.begin() + head);
+    for (auto& frame : frames) {
+        frame.offset -= consumedBytes;
+    }
+    head = 0;
+    consumedBytes = 0;
+}
+
+} // namespace owop
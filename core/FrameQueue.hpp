@@ -0,0 +1,48 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace owop {
+
+// FIFO of websocket frames waiting to be written, one per send lane.
+// Payloads are packed back to back in one buffer that is compacted as the
+// front is consumed, so a busy queue stops allocating once it has grown to its
+// usual depth.
+// Not thread-safe: NetworkImpl only uses it on the websocket thread.
+class FrameQueue {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Frame {
+        size_t offset;  // Into the payload buffer
+        size_t length;
+        bool text;      // Text frame (captcha token) rather than binary
+        Clock::time_point queuedAt;
+    };
+
+    void push(const void* data, size_t length, bool text, Clock::time_point now);
+
+    // Oldest frame; only valid while !empty()
+    const Frame& front() const { return frames[head]; }
+    const uint8_t* payloadOf(const Frame& frame) const { return payload.data() + frame.offset; }
+    void popFront();
+
+    // Keeps the buffers for reuse
+    void clear();
+
+    bool empty() const { return head == frames.size(); }
+    size_t frameCount() const { return frames.size() - head; }
+    size_t byteCount() const { return payload.size() - consumedBytes; }
+
+private:
+    void compact();
+
+    std::vector<uint8_t> payload;
+    std::vector<Frame> frames;
+    size_t head{0};           // Index of the oldest unsent frame
+    size_t consumedBytes{0};  // Payload bytes in front of it
+};
+
+} // namespace owop
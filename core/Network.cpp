@@ -38,10 +38,8 @@ void Network::disconnect() {
     if (networkThread.joinable()) {
         networkThread.join();
     }
-    
-    if (captchaServer) {
-        captchaServer->stop();
-    }
+
+    // The captcha server is started and stopped by the session on the websocket thread
 }
 
 void Network::submitCaptcha(const std::string& token) {
@@ -49,9 +47,14 @@ void Network::submitCaptcha(const std::string& token) {
     impl->submitCaptcha(token);
 }
 
-void Network::requestChunksInView(int32_t centerX, int32_t centerY, float zoom) {
+void Network::requestChunksInView(int32_t centerX, int32_t centerY, float zoom, int viewportWidth, int viewportHeight) {
     if (!impl) return;
-    impl->requestChunksInView(centerX, centerY, zoom);
+    impl->requestChunksInView(centerX, centerY, zoom, viewportWidth, viewportHeight);
+}
+
+void Network::forgetChunks(const std::vector<Vec2i>& chunks) {
+    if (!impl) return;
+    impl->forgetChunks(chunks);
 }
 
 bool Network::isWaitingForCaptcha() const {
@@ -59,13 +62,73 @@ bool Network::isWaitingForCaptcha() const {
     return impl->isWaitingForCaptcha();
 }
 
-void Network::setChunkDataCallback(std::function<void(int, int, const std::vector<Color>&)> callback) {
+ChunkPipelineStats Network::getChunkPipelineStats() const {
+    if (!impl) return ChunkPipelineStats{};
+    return impl->getChunkPipelineStats();
+}
+
+void Network::setChunkDataCallback(std::function<void(int, int, ChunkPixels&)> callback) {
     if (!impl) return;
     impl->setChunkDataCallback(callback);
 }
 
-const std::unordered_map<uint32_t, Player>& Network::getPlayers() const {
-    static std::unordered_map<uint32_t, Player> empty;
+void Network::setPixelBatchCallback(std::function<void(const PixelBatch&)> callback) {
+    if (!impl) return;
+    impl->setPixelBatchCallback(callback);
+}
+
+void Network::setTeleportCallback(std::function<void(int32_t, int32_t)> callback) {
+    if (!impl) return;
+    impl->setTeleportCallback(callback);
+}
+
+void Network::dispatchEvents() {
+    if (!impl) return;
+    impl->dispatchEvents();
+}
+
+ConnectionStats Network::getConnectionStats() const {
+    if (!impl) return ConnectionStats{};
+    return impl->getConnectionStats();
+}
+
+CompressionStats Network::getCompressionStats() const {
+    if (!impl) return CompressionStats{};
+    return impl->getCompressionStats();
+}
+
+SendStats Network::getSendStats() const {
+    if (!impl) return SendStats{};
+    return impl->getSendStats();
+}
+
+EventQueueStats Network::getEventQueueStats() const {
+    if (!impl) return EventQueueStats{};
+    return impl->getEventQueueStats();
+}
+
+uint32_t Network::getPlayerId() const {
+    if (!impl) return 0;
+    return impl->getPlayerId();
+}
+
+bool Network::placePixel(int32_t x, int32_t y, const Color& color) {
+    if (!impl) return false;
+    return impl->placePixel(x, y, color);
+}
+
+void Network::moveCursor(int32_t x, int32_t y, const Color& color, uint8_t tool) {
+    if (!impl) return;
+    impl->moveCursor(x, y, color, tool);
+}
+
+PixelWriteStats Network::getPixelWriteStats() const {
+    if (!impl) return PixelWriteStats{};
+    return impl->getPixelWriteStats();
+}
+
+PlayerSnapshotPtr Network::getPlayers() const {
+    static const PlayerSnapshotPtr empty = std::make_shared<const PlayerSnapshot>();
     if (!impl) return empty;
     return impl->getPlayers();
 }
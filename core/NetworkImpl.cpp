@@ -1,378 +1,891 @@
 #include "NetworkImpl.hpp"
 #include <owop-client/Logger.hpp>
 #include <owop-client/Settings.hpp>
+#include <owop-client/Constants.hpp>
+#include <owop-client/Protocol.hpp>
+#include <owop-client/ProtocolDecoder.hpp>
 #include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
 
 namespace owop {
 
+namespace {
+
+// Buffered socket bytes at which each lane stops writing. Lower lanes stop
+// first, so there is always room left for the lanes above them.
+constexpr size_t LANE_HIGH_WATER[SEND_LANE_COUNT] = {
+    SIZE_MAX,                   // Control is never held back
+    SEND_HIGH_WATER_BYTES,      // Pixels
+    SEND_HIGH_WATER_BYTES / 2,  // Visible chunks
+    SEND_HIGH_WATER_BYTES / 4,  // Prefetch chunks
+    SEND_HIGH_WATER_BYTES / 4   // Moves
+};
+
+uint64_t chunkKey(int32_t chunkX, int32_t chunkY) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(chunkX)) << 32) | static_cast<uint32_t>(chunkY);
+}
+
+} // namespace
+
 NetworkImpl::NetworkImpl(std::unique_ptr<CaptchaServer>* captchaServer)
     : captchaServer(captchaServer)
-    , connected(false)
-    , connecting(false)
-    , waitingForCaptcha(false)
+    , playerSnapshots(std::make_shared<const PlayerSnapshot>())
+    , chunkWindow(CHUNK_WINDOW_MAX)
 {
-    // Initialize WebSocket client
-    client.clear_access_channels(websocketpp::log::alevel::all);
-    client.clear_error_channels(websocketpp::log::elevel::all);
-    client.set_access_channels(websocketpp::log::alevel::connect);
-    client.set_access_channels(websocketpp::log::alevel::disconnect);
-    client.set_access_channels(websocketpp::log::alevel::app);
-    client.set_error_channels(websocketpp::log::elevel::fatal);
-
-    client.init_asio();
-
-    // Set up TLS
-    client.set_tls_init_handler([](websocketpp::connection_hdl) {
-        auto ctx = websocketpp::lib::make_shared<boost::asio::ssl::context>(
-            boost::asio::ssl::context::tlsv12);
-        ctx->set_verify_mode(boost::asio::ssl::verify_none);
-        return ctx;
+    chunkTimer = std::make_unique<boost::asio::steady_timer>(io);
+    pixelTimer = std::make_unique<boost::asio::steady_timer>(io);
+    reconnectTimer = std::make_unique<boost::asio::steady_timer>(io);
+    sendRetryTimer = std::make_unique<boost::asio::steady_timer>(io);
+
+    // One TLS context for the lifetime of the client, with a client-side session cache
+    tlsContext = std::make_shared<boost::asio::ssl::context>(boost::asio::ssl::context::tlsv12);
+    tlsContext->set_verify_mode(boost::asio::ssl::verify_none);
+    SSL_CTX_set_session_cache_mode(tlsContext->native_handle(), SSL_SESS_CACHE_CLIENT);
+
+    initClient(tlsClient);
+    initClient(plainClient);
+
+    tlsClient.set_tls_init_handler([this](websocketpp::connection_hdl) {
+        return tlsContext;
     });
 
-    // Set up callbacks
-    client.set_open_handler([this](WebSocketConnection hdl) {
-        Logger::info("Network", "WebSocket connected");
-        connection = hdl;
-        connected = true;
-        connecting = false;
+    // Offer the previous session so the server can skip the full handshake
+    tlsClient.set_socket_init_handler([this](websocketpp::connection_hdl,
+                                             boost::asio::ssl::stream<boost::asio::ip::tcp::socket>& stream) {
+        if (tlsSession) {
+            SSL_set_session(stream.native_handle(), tlsSession);
+        }
+    });
+}
 
-        // If we have a pending token, send it now
-        if (!pendingToken.empty()) {
-            Logger::info("Network", "Sending pending captcha token...");
-            try {
-                auto con = client.get_con_from_hdl(connection);
-                std::string tokenMsg = "CaptchA" + pendingToken;
-                con->send(tokenMsg);
-                Logger::info("Network", "Sent captcha token");
-            } catch (const std::exception& e) {
-                Logger::error("Network", "Failed to send token: " + std::string(e.what()));
+template<typename Client>
+void NetworkImpl::initClient(Client& endpoint) {
+    endpoint.clear_access_channels(websocketpp::log::alevel::all);
+    endpoint.clear_error_channels(websocketpp::log::elevel::all);
+    endpoint.set_access_channels(websocketpp::log::alevel::connect);
+    endpoint.set_access_channels(websocketpp::log::alevel::disconnect);
+    endpoint.set_access_channels(websocketpp::log::alevel::app);
+    endpoint.set_error_channels(websocketpp::log::elevel::fatal);
+
+    endpoint.init_asio(&io);
+
+    // Open, fail, close and message handlers are set per connection in startConnection()
+}
+
+void NetworkImpl::saveTlsSession(SSL* ssl) {
+    tlsHandshakes++;
+    if (SSL_session_reused(ssl)) {
+        tlsResumptions++;
+    }
+
+    // Keep the newest session for the next handshake
+    SSL_SESSION* session = SSL_get1_session(ssl);
+    if (session) {
+        if (tlsSession) {
+            SSL_SESSION_free(tlsSession);
+        }
+        tlsSession = session;
+    }
+}
+
+websocketpp::lib::error_code NetworkImpl::sendFrame(const void* data, size_t length,
+                                                    websocketpp::frame::opcode::value opcode) {
+    websocketpp::lib::error_code ec;
+    if (useTls) {
+        tlsClient.send(connection, data, length, opcode, ec);
+    } else {
+        plainClient.send(connection, data, length, opcode, ec);
+    }
+    return ec;
+}
+
+size_t NetworkImpl::bufferedAmount() {
+    websocketpp::lib::error_code ec;
+    size_t amount = 0;
+    if (useTls) {
+        auto con = tlsClient.get_con_from_hdl(connection, ec);
+        if (!ec) amount = con->get_buffered_amount();
+    } else {
+        auto con = plainClient.get_con_from_hdl(connection, ec);
+        if (!ec) amount = con->get_buffered_amount();
+    }
+    return amount;
+}
+
+bool NetworkImpl::queueFrame(SendLane lane, const void* data, size_t length, bool text) {
+    if (!isOpen()) return false;
+
+    auto index = static_cast<size_t>(lane);
+    FrameQueue& queue = laneQueues[index];
+    LaneCounters& counters = laneCounters[index];
+
+    // Only the newest cursor position matters
+    if (lane == SendLane::Moves && !queue.empty()) {
+        counters.replaced += queue.frameCount();
+        queue.clear();
+    }
+
+    queue.push(data, length, text, FrameQueue::Clock::now());
+    counters.peakFrames = std::max(counters.peakFrames, queue.frameCount());
+
+    // One flush per batch: frames queued before it runs ride along
+    if (!flushPosted) {
+        flushPosted = true;
+        boost::asio::post(io, [this]() { flushOutbound(); });
+    }
+    return true;
+}
+
+void NetworkImpl::flushOutbound() {
+    flushPosted = false;
+    if (!isOpen() || !connection.lock()) return;
+
+    // Lanes in priority order, each until the socket holds its high-water mark.
+    // websocketpp gathers everything queued behind a write in progress into the
+    // next write, so one flush reaches the socket in one or two writes.
+    auto now = FrameQueue::Clock::now();
+    size_t buffered = bufferedAmount();
+    bool heldBack = false;
+    for (size_t lane = 0; lane < SEND_LANE_COUNT; lane++) {
+        FrameQueue& queue = laneQueues[lane];
+        LaneCounters& counters = laneCounters[lane];
+
+        while (!queue.empty() && buffered < LANE_HIGH_WATER[lane]) {
+            const auto& frame = queue.front();
+            auto ec = sendFrame(queue.payloadOf(frame), frame.length,
+                frame.text ? websocketpp::frame::opcode::text : websocketpp::frame::opcode::binary);
+            if (ec) {
+                Logger::error("Network", std::string("Failed to send ") + toString(static_cast<SendLane>(lane)) +
+                    " frame: " + ec.message());
             }
-            pendingToken.clear();
+
+            double waitMs = std::chrono::duration<double, std::milli>(now - frame.queuedAt).count();
+            counters.avgWaitMs = counters.sent == 0 ? waitMs : counters.avgWaitMs * 0.9 + waitMs * 0.1;
+            counters.maxWaitMs = std::max(counters.maxWaitMs, waitMs);
+            counters.sent++;
+            buffered += frame.length;
+            queue.popFront();
         }
-    });
+        heldBack = heldBack || !queue.empty();
+    }
+    sendFlushes.fetch_add(1, std::memory_order_relaxed);
 
-    client.set_close_handler([this](WebSocketConnection hdl) {
-        auto con = client.get_con_from_hdl(hdl);
-        std::string reason = con->get_remote_close_reason();
-        Logger::info("Network", "WebSocket disconnected - Reason: " + reason);
-        
-        connected = false;
-        connecting = false;
-        connection.reset();
-        pendingToken.clear();
+    lastBufferedAmount.store(buffered, std::memory_order_relaxed);
+    if (buffered > peakBufferedAmount.load(std::memory_order_relaxed)) {
+        peakBufferedAmount.store(buffered, std::memory_order_relaxed);
+    }
+    if (heldBack) {
+        waitForSendRoom();
+    }
+}
+
+bool NetworkImpl::sendCongested(SendLane lane) {
+    size_t queued = laneQueues[static_cast<size_t>(lane)].byteCount();
+    if (queued + bufferedAmount() < LANE_HIGH_WATER[static_cast<size_t>(lane)]) {
+        return false;
+    }
+
+    sendStalls.fetch_add(1, std::memory_order_relaxed);
+    waitForSendRoom();
+    return true;
+}
+
+void NetworkImpl::waitForSendRoom() {
+    if (sendRetryArmed || !isOpen()) return;
+
+    // The socket gives no drain notification, so look again shortly
+    sendRetryArmed = true;
+    sendRetryTimer->expires_after(std::chrono::milliseconds(SEND_RETRY_MS));
+    sendRetryTimer->async_wait([this](const boost::system::error_code& ec) {
+        sendRetryArmed = false;
+        if (ec || !isOpen()) return;  // Cancelled on close
+        flushOutbound();
+        processNextChunks();
+        flushPixelWrites();
     });
+}
+
+void NetworkImpl::closeConnection(const std::string& reason) {
+    websocketpp::lib::error_code ec;
+    if (useTls) {
+        tlsClient.close(connection, websocketpp::close::status::normal, reason, ec);
+    } else {
+        plainClient.close(connection, websocketpp::close::status::normal, reason, ec);
+    }
+    if (ec) {
+        Logger::error("Network", "Error during disconnect: " + ec.message());
+    }
+}
+
+void NetworkImpl::enterState(SessionState next) {
+    SessionState previous = state;
+    if (next == previous) return;
 
-    client.set_message_handler([this](WebSocketConnection hdl, WebSocketClient::message_ptr msg) {
+    auto now = std::chrono::steady_clock::now();
+    double elapsedMs = std::chrono::duration<double, std::milli>(now - stateEnteredAt).count();
+    phaseMs[static_cast<size_t>(previous)].store(elapsedMs, std::memory_order_relaxed);
+    stateEnteredAt = now;
+    state = next;
+
+    if (previous != SessionState::Idle) {
+        Logger::info("Network", std::string(toString(previous)) + " took " +
+            std::to_string(static_cast<int64_t>(elapsedMs)) + " ms, now " + toString(next));
+    }
+    publishStats();
+}
+
+void NetworkImpl::startWebsocketThread() {
+    // Started on the first connect; the work guard keeps it alive between connections
+    if (websocketThread.joinable()) return;
+
+    ioWork = std::make_unique<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>>(
+        io.get_executor());
+
+    // Run the ASIO io_context in a separate thread
+    websocketThread = std::thread([this]() {
         try {
-            handleMessage(msg->get_payload());
+            io.run();
         } catch (const std::exception& e) {
-            Logger::error("Network", "Error handling message: " + std::string(e.what()));
+            Logger::error("Network", "WebSocket thread error: " + std::string(e.what()));
         }
     });
+}
 
-    client.set_fail_handler([this](WebSocketConnection hdl) {
-        auto con = client.get_con_from_hdl(hdl);
-        Logger::error("Network", "Connection failed: " + con->get_ec().message());
-        
-        connected = false;
-        connecting = false;
-        connection.reset();
-        pendingToken.clear();
+void NetworkImpl::connect(const std::string& url, const std::string& world) {
+    // Settings belong to the main thread; read them here
+    size_t maxWindow = static_cast<size_t>(std::max(1, Settings::getInstance().maxChunksInFlight));
+    DeflateTraffic::offer = Settings::getInstance().compressTraffic;
+
+    startWebsocketThread();
+    boost::asio::post(io, [this, url, world, maxWindow]() {
+        if (state != SessionState::Idle) {
+            Logger::info("Network", "Already connecting/connected - skipping connect");
+            return;
+        }
+
+        worldName = world;
+        serverUrl = url;
+        useTls = url.compare(0, 5, "ws://") != 0;  // Anything but ws:// goes over TLS
+        userDisconnected = false;
+        reconnectAttempt = 0;
+
+        // Clear chunk state
+        chunkScheduler.clear();
+        chunkWindow.setMaxWindow(maxWindow);
+        chunkWindow.reset();
+
+        // Start captcha server if not already running
+        if (captchaServer && *captchaServer && !(*captchaServer)->isRunning()) {
+            Logger::info("Network", "Starting captcha server...");
+            (*captchaServer)->start();
+        }
+
+        enterState(SessionState::Connecting);
+        attemptConnection();
     });
 }
 
-void NetworkImpl::connect(const std::string& url, const std::string& world) {
-    if (connecting || connected) {
-        Logger::info("Network", "Already connecting/connected - skipping connect");
-        return;
-    }
-    
-    worldName = world;
-    serverUrl = url;
-    connecting = true;
-    waitingForCaptcha = true;  // Always start with captcha check
-    
-    // Clear chunk state
+void NetworkImpl::resetSession() {
+    chunkTimer->cancel();
+    pixelTimer->cancel();
+    sendRetryTimer->cancel();
+    connection.reset();
+    pendingToken.clear();
+    playerId = 0;  // Until the next setId
     {
-        std::lock_guard<std::mutex> lock(chunkMutex);
-        std::queue<ChunkCoord>().swap(chunkRequestQueue);  // Clear queue
-        loadedChunks.clear();
-        pendingChunks.clear();
-        waitingForChunk = false;
+        std::lock_guard<std::mutex> lock(pixelMutex);
+        pixelQueue.clear();
+        protectedChunks.clear();  // Sent again with the chunks
     }
-    
-    // Start captcha server if not already running
-    if (captchaServer && *captchaServer && !(*captchaServer)->isRunning()) {
-        Logger::info("Network", "Starting captcha server...");
-        (*captchaServer)->start();
+
+    // Frames for the old socket would be written to the new one
+    for (auto& queue : laneQueues) {
+        queue.clear();
     }
+    lastBufferedAmount = 0;
 
-    // Initialize WebSocket if needed
-    if (!client.is_listening()) {
-        client.reset();
-        client.start_perpetual();
-        
-        // Run the ASIO io_service in a separate thread
-        websocketThread = std::thread([this]() {
-            try {
-                client.run();
-            } catch (const std::exception& e) {
-                Logger::error("Network", "WebSocket thread error: " + std::string(e.what()));
-            }
-        });
+    // Requests on the old socket are gone. The renderer keeps showing the chunks it
+    // has; once we are back in the world the visible ones are fetched again.
+    chunkScheduler.clear();
+    chunkWindow.reset();
+
+    // Cursors from the old session are stale
+    players.clear();
+    publishPlayerSnapshot();
+}
+
+void NetworkImpl::handleConnectionLost() {
+    resetSession();
+
+    if (userDisconnected) {
+        enterState(SessionState::Idle);
+    } else {
+        scheduleReconnect();
     }
+}
 
-    // Attempt connection
-    attemptConnection();
+void NetworkImpl::scheduleReconnect() {
+    // Exponential backoff with jitter: a random delay in [base/2, base] so clients
+    // dropped by the same outage don't all come back at once
+    int exponent = std::min(reconnectAttempt.load(), 16);
+    int64_t base = std::min<int64_t>(static_cast<int64_t>(RECONNECT_BASE_MS) << exponent, RECONNECT_MAX_MS);
+    std::uniform_int_distribution<int64_t> jitter(base / 2, base);
+    auto delay = std::chrono::milliseconds(jitter(reconnectRng));
+
+    reconnectAttempt++;
+    enterState(SessionState::Reconnecting);
+    Logger::info("Network", "Reconnecting in " + std::to_string(delay.count()) + " ms (attempt " +
+        std::to_string(reconnectAttempt) + ")");
+
+    reconnectTimer->expires_after(delay);
+    reconnectTimer->async_wait([this](const boost::system::error_code& ec) {
+        if (ec || userDisconnected) return;  // Cancelled by disconnect()
+        reconnects++;
+        enterState(SessionState::Connecting);
+        attemptConnection();
+    });
 }
 
 void NetworkImpl::attemptConnection() {
     try {
-        // Create new connection
-        websocketpp::lib::error_code ec;
-        auto con = client.get_connection(serverUrl, ec);
-        
-        if (ec) {
-            Logger::error("Network", "Could not create connection: " + ec.message());
-            connecting = false;
-            return;
+        bool started = useTls ? startConnection(tlsClient) : startConnection(plainClient);
+        if (!started) {
+            if (reconnectAttempt > 0 && !userDisconnected) {
+                scheduleReconnect();
+            } else {
+                enterState(SessionState::Idle);
+            }
         }
-
-        // Set headers
-        con->append_header("Origin", "https://ourworldofpixels.com");
-        con->append_header("User-Agent", "Mozilla/5.0");
-        con->append_header("Pragma", "no-cache");
-        con->append_header("Cache-Control", "no-cache");
-
-        // Connect
-        Logger::info("Network", "Connecting to " + serverUrl);
-        client.connect(con);
     } catch (const std::exception& e) {
         Logger::error("Network", "Failed to connect: " + std::string(e.what()));
-        connecting = false;
+        enterState(SessionState::Idle);
     }
 }
 
-void NetworkImpl::disconnect() {
-    if (!connected && !connecting) return;
-
-    Logger::info("Network", "Disconnecting...");
-    
-    // Clear chunk state
-    {
-        std::lock_guard<std::mutex> lock(chunkMutex);
-        std::queue<ChunkCoord>().swap(chunkRequestQueue);
-        loadedChunks.clear();
-        pendingChunks.clear();
-        waitingForChunk = false;
-    }
+template<typename Client>
+bool NetworkImpl::startConnection(Client& endpoint) {
+    // Create new connection
+    websocketpp::lib::error_code ec;
+    auto con = endpoint.get_connection(serverUrl, ec);
     
-    // Stop the captcha server first
-    if (captchaServer && *captchaServer && (*captchaServer)->isRunning()) {
-        (*captchaServer)->stop();
+    if (ec) {
+        Logger::error("Network", "Could not create connection: " + ec.message());
+        return false;
     }
 
-    // Close WebSocket connection if active
-    if (connection.lock()) {
+    // Set headers
+    con->append_header("Origin", "https://ourworldofpixels.com");
+    con->append_header("User-Agent", "Mozilla/5.0");
+    con->append_header("Pragma", "no-cache");
+    con->append_header("Cache-Control", "no-cache");
+
+    // Handlers are bound to this attempt. A connection abandoned by disconnect()
+    // can still open, fail or close afterwards; by then the generation has moved
+    // on, so it can't be taken for the current session or tear it down.
+    uint64_t generation = ++connectionGeneration;
+
+    con->set_open_handler([this, &endpoint, generation](WebSocketConnection hdl) {
+        if (generation != connectionGeneration) {
+            websocketpp::lib::error_code ec;
+            endpoint.close(hdl, websocketpp::close::status::going_away, "Client disconnecting", ec);
+            return;
+        }
+
+        Logger::info("Network", "WebSocket connected");
+        connection = hdl;
+        enterState(SessionState::Captcha);
+        scheduleChunkTimer();
+
+        auto con = endpoint.get_con_from_hdl(hdl);
+        if constexpr (std::is_same<Client, WebSocketTlsClient>::value) {
+            saveTlsSession(con->get_socket().native_handle());
+        }
+
+        deflateNegotiated = con->get_response_header("Sec-WebSocket-Extensions").find("permessage-deflate") != std::string::npos;
+        if (deflateNegotiated) {
+            Logger::info("Network", "Server accepted permessage-deflate");
+        }
+
+        // If we have a pending token, send it now
+        if (!pendingToken.empty()) {
+            Logger::info("Network", "Sending pending captcha token...");
+            sendCaptchaToken(pendingToken);
+            pendingToken.clear();
+        }
+    });
+
+    con->set_close_handler([this, &endpoint, generation](WebSocketConnection hdl) {
+        auto con = endpoint.get_con_from_hdl(hdl);
+        std::string reason = con->get_remote_close_reason();
+        Logger::info("Network", "WebSocket disconnected - Reason: " + reason);
+
+        if (generation != connectionGeneration) return;  // Abandoned by disconnect()
+        handleConnectionLost();
+    });
+
+    con->set_message_handler([this, generation](WebSocketConnection, typename Client::message_ptr msg) {
+        // Frames still arriving on a connection we are closing
+        if (generation != connectionGeneration) return;
+
+        // Only binary frames carry protocol messages; text frames are chat
+        if (msg->get_opcode() != websocketpp::frame::opcode::binary) return;
+
+        messagesIn.fetch_add(1, std::memory_order_relaxed);
+        payloadBytesIn.fetch_add(msg->get_payload().size(), std::memory_order_relaxed);
+        if (msg->get_compressed()) {
+            compressedMessagesIn.fetch_add(1, std::memory_order_relaxed);
+        }
+
         try {
-            auto con = client.get_con_from_hdl(connection);
-            if (con && con->get_state() == websocketpp::session::state::open) {
-                con->close(websocketpp::close::status::normal, "Client disconnecting");
-            }
+            handleMessage(msg->get_payload());
         } catch (const std::exception& e) {
-            Logger::error("Network", "Error during disconnect: " + std::string(e.what()));
+            Logger::error("Network", "Error handling message: " + std::string(e.what()));
         }
-    }
+    });
 
-    // Reset state
-    connecting = false;
-    connected = false;
-    waitingForCaptcha = false;
-    connection.reset();
-    pendingToken.clear();
+    con->set_fail_handler([this, &endpoint, generation](WebSocketConnection hdl) {
+        auto con = endpoint.get_con_from_hdl(hdl);
+        Logger::error("Network", "Connection failed: " + con->get_ec().message());
+
+        if (generation != connectionGeneration) return;  // Abandoned by disconnect()
+        handleConnectionLost();
+    });
+
+    // Connect
+    Logger::info("Network", "Connecting to " + serverUrl);
+    endpoint.connect(con);
+    return true;
+}
+
+void NetworkImpl::disconnect() {
+    boost::asio::post(io, [this]() {
+        if (state == SessionState::Idle) return;
 
-    // Stop WebSocket client if it's running
-    if (client.is_listening()) {
-        client.stop_perpetual();
-        if (websocketThread.joinable()) {
-            websocketThread.join();
+        Logger::info("Network", "Disconnecting...");
+
+        // Don't come back on our own
+        userDisconnected = true;
+        reconnectTimer->cancel();
+
+        // Stop the captcha server first
+        if (captchaServer && *captchaServer && (*captchaServer)->isRunning()) {
+            (*captchaServer)->stop();
         }
+
+        // Close WebSocket connection if active. Its close handler, or the open or
+        // fail handler of a handshake still in flight, runs later and is ignored.
+        if (isOpen() && connection.lock()) {
+            closeConnection("Client disconnecting");
+        }
+        connectionGeneration++;
+
+        resetSession();
+        enterState(SessionState::Idle);
+    });
+}
+
+void NetworkImpl::sendCaptchaToken(const std::string& token) {
+    std::string tokenMsg = "CaptchA" + token;
+    if (!queueFrame(SendLane::Control, tokenMsg.data(), tokenMsg.size(), true)) {
+        Logger::error("Network", "Failed to send token: not connected");
+    } else {
+        Logger::info("Network", "Sent captcha token");
     }
 }
 
 void NetworkImpl::submitCaptcha(const std::string& token) {
-    Logger::info("Network", "Received captcha token");
-    
-    if (!token.empty()) {
-        pendingToken = token;
-        waitingForCaptcha = false;
-        
-        if (connected) {
+    // Called on the captcha server's thread
+    boost::asio::post(io, [this, token]() {
+        if (token.empty()) {
+            Logger::error("Network", "Received empty captcha token");
+            return;
+        }
+        Logger::info("Network", "Received captcha token");
+
+        if (isOpen()) {
             // Send token directly
-            try {
-                auto con = client.get_con_from_hdl(connection);
-                std::string tokenMsg = "CaptchA" + token;
-                con->send(tokenMsg);
-                Logger::info("Network", "Sent captcha token");
-            } catch (const std::exception& e) {
-                Logger::error("Network", "Failed to send token: " + std::string(e.what()));
-            }
-            pendingToken.clear();
-        } else if (!connecting) {
+            sendCaptchaToken(token);
+        } else if (state == SessionState::Idle && !serverUrl.empty()) {
             // If not connecting, attempt connection
             Logger::info("Network", "Stored captcha token and attempting connection");
+            pendingToken = token;
+            userDisconnected = false;
+            enterState(SessionState::Connecting);
             attemptConnection();
         } else {
             Logger::info("Network", "Stored captcha token for when connection is established");
+            pendingToken = token;
         }
-    } else {
-        Logger::error("Network", "Received empty captcha token");
-    }
+    });
 }
 
-bool NetworkImpl::isChunkQueued(const ChunkCoord& coord) const {
-    // Check if the chunk is in the queue
-    auto queue = chunkRequestQueue;
-    while (!queue.empty()) {
-        if (queue.front() == coord) return true;
-        queue.pop();
-    }
-    return false;
+void NetworkImpl::requestChunksInView(int32_t centerX, int32_t centerY, float zoom, int viewportWidth, int viewportHeight) {
+    boost::asio::post(io, [this, view = ViewRequest{centerX, centerY, zoom, viewportWidth, viewportHeight, true}]() {
+        // Remembered so the view can be fetched again after (re)joining the world
+        lastView = view;
+        if (state != SessionState::InWorld) return;
+        enqueueChunksInView(view.centerX, view.centerY, view.zoom, view.viewportWidth, view.viewportHeight);
+    });
+}
+
+void NetworkImpl::forgetChunks(const std::vector<Vec2i>& chunks) {
+    boost::asio::post(io, [this, chunks]() {
+        // No longer loaded: pixel updates for them are dropped and a view over them requests them again
+        for (const auto& chunk : chunks) {
+            chunkScheduler.forget(ChunkCoord{chunk.x, chunk.y});
+        }
+    });
 }
 
-void NetworkImpl::requestChunksInView(int32_t centerX, int32_t centerY, float zoom) {
-    if (!connected) return;
+void NetworkImpl::requestChunksInLastView() {
+    if (lastView.valid) {
+        enqueueChunksInView(lastView.centerX, lastView.centerY, lastView.zoom, lastView.viewportWidth,
+            lastView.viewportHeight);
+    }
+}
 
+void NetworkImpl::enqueueChunksInView(int32_t centerX, int32_t centerY, float zoom, int viewportWidth, int viewportHeight) {
     try {
-        // Calculate visible area in chunks (16x16 pixels per chunk)
-        const int32_t CHUNK_SIZE = 16;
-        const int32_t viewportWidth = 800;  // TODO: Get actual viewport size
-        const int32_t viewportHeight = 600;
-        
         // Convert world coordinates to chunk coordinates
         int32_t centerChunkX = static_cast<int32_t>(std::floor(static_cast<float>(centerX) / CHUNK_SIZE));
         int32_t centerChunkY = static_cast<int32_t>(std::floor(static_cast<float>(centerY) / CHUNK_SIZE));
         
-        // Calculate how many chunks we can see based on zoom level
-        int32_t visibleChunksX = std::max(1, static_cast<int32_t>((viewportWidth / zoom) / CHUNK_SIZE) + 1);
-        int32_t visibleChunksY = std::max(1, static_cast<int32_t>((viewportHeight / zoom) / CHUNK_SIZE) + 1);
+        // Calculate how many chunks we can see in each direction based on zoom level
+        float chunkScreenSize = zoom * CHUNK_SIZE;
+        int32_t visibleChunksX = std::max(1, static_cast<int32_t>(std::ceil(viewportWidth / (2.0f * chunkScreenSize))));
+        int32_t visibleChunksY = std::max(1, static_cast<int32_t>(std::ceil(viewportHeight / (2.0f * chunkScreenSize))));
 
         // Limit the number of chunks to request at once
-        visibleChunksX = std::min(visibleChunksX, 16);
-        visibleChunksY = std::min(visibleChunksY, 16);
-
-        bool shouldProcessNext = false;
-        {
-            std::lock_guard<std::mutex> lock(chunkMutex);
-
-            // Add visible chunks to request queue if not already loaded or pending
-            for (int32_t y = centerChunkY - visibleChunksY; y <= centerChunkY + visibleChunksY; y++) {
-                for (int32_t x = centerChunkX - visibleChunksX; x <= centerChunkX + visibleChunksX; x++) {
-                    ChunkCoord coord{x, y};
-                    if (loadedChunks.find(coord) == loadedChunks.end() && 
-                        pendingChunks.find(coord) == pendingChunks.end() &&
-                        !isChunkQueued(coord)) {
-                        chunkRequestQueue.push(coord);
-                    }
-                }
-            }
+        visibleChunksX = std::min(visibleChunksX, CHUNK_VIEW_RADIUS_MAX);
+        visibleChunksY = std::min(visibleChunksY, CHUNK_VIEW_RADIUS_MAX);
+
+        // Serve chunks nearest the view center first and drop queued
+        // requests that are no longer within the view plus a margin
+        ChunkRect keepArea{
+            centerChunkX - visibleChunksX - CHUNK_CANCEL_MARGIN,
+            centerChunkY - visibleChunksY - CHUNK_CANCEL_MARGIN,
+            centerChunkX + visibleChunksX + CHUNK_CANCEL_MARGIN,
+            centerChunkY + visibleChunksY + CHUNK_CANCEL_MARGIN
+        };
+        chunkScheduler.setView(centerChunkX, centerChunkY, keepArea);
 
-            // Check if we should process next chunk
-            shouldProcessNext = !waitingForChunk && !chunkRequestQueue.empty();
+        visibleArea = ChunkRect{
+            centerChunkX - visibleChunksX,
+            centerChunkY - visibleChunksY,
+            centerChunkX + visibleChunksX,
+            centerChunkY + visibleChunksY
+        };
+
+        // Add visible chunks and a prefetch ring around them to the request queue
+        // if not already queued, loaded or pending. The queue serves the nearest first.
+        int32_t reachX = visibleChunksX + CHUNK_PREFETCH_MARGIN;
+        int32_t reachY = visibleChunksY + CHUNK_PREFETCH_MARGIN;
+        for (int32_t y = centerChunkY - reachY; y <= centerChunkY + reachY; y++) {
+            for (int32_t x = centerChunkX - reachX; x <= centerChunkX + reachX; x++) {
+                chunkScheduler.enqueue(ChunkCoord{x, y});
+            }
         }
 
-        // Process next chunk outside of mutex lock if needed
-        if (shouldProcessNext) {
-            processNextChunk();
+        // Fill the window if there is room
+        if (chunkScheduler.pendingCount() < chunkWindow.size() && chunkScheduler.queuedCount() > 0) {
+            processNextChunks();
         }
     } catch (const std::exception& e) {
         Logger::error("Network", "Error in requestChunksInView: " + std::string(e.what()));
     }
 }
 
-void NetworkImpl::processNextChunk() {
-    if (!connected) return;
+void NetworkImpl::processNextChunks() {
+    if (state != SessionState::InWorld) return;
+
+    // Leave chunks queued (and cancellable) while the socket is backed up
+    if (sendCongested(SendLane::VisibleChunks)) return;
 
     try {
-        ChunkCoord coord;
-        bool shouldRequest = false;
-        
-        {
-            std::lock_guard<std::mutex> lock(chunkMutex);
-            
-            if (chunkRequestQueue.empty() || waitingForChunk) {
-                return;
-            }
+        auto now = ChunkScheduler::Clock::now();
 
-            coord = chunkRequestQueue.front();
-            chunkRequestQueue.pop();
+        // Wait at least a few smoothed RTTs before treating a request as lost
+        auto timeout = std::chrono::milliseconds(std::max(CHUNK_TIMEOUT_MS,
+            static_cast<int>(chunkWindow.getSmoothedRttMs() * 4)));
 
-            // Skip if already loaded or pending
-            if (loadedChunks.find(coord) == loadedChunks.end() &&
-                pendingChunks.find(coord) == pendingChunks.end()) {
-                pendingChunks.insert(coord);
-                waitingForChunk = true;
-                shouldRequest = true;
-            }
+        // Send as many requests as the window currently allows
+        ChunkCoord coord;
+        while (chunkScheduler.pendingCount() < chunkWindow.size() && chunkScheduler.popNext(coord, now, timeout)) {
+            // Chunks that would be on screen go ahead of the prefetch ring and of
+            // queued requests the view has since moved away from
+            requestChunk(coord, visibleArea.contains(coord) ? SendLane::VisibleChunks : SendLane::PrefetchChunks);
         }
+    } catch (const std::exception& e) {
+        Logger::error("Network", "Error in processNextChunks: " + std::string(e.what()));
+    }
+}
 
-        // Request the chunk outside of mutex lock if needed
-        if (shouldRequest) {
-            requestChunk(coord.x, coord.y);
+void NetworkImpl::refetchChunk(const ChunkCoord& coord) {
+    // Queued requests are only issued on pan or zoom otherwise, so queue it here;
+    // it is dropped like any other if the view has moved away by then
+    chunkScheduler.forget(coord);
+    chunkScheduler.enqueue(coord);
+}
+
+void NetworkImpl::scheduleChunkTimer() {
+    chunkTimer->expires_after(std::chrono::milliseconds(CHUNK_TIMER_INTERVAL_MS));
+    chunkTimer->async_wait([this](const boost::system::error_code& ec) {
+        if (ec || !isOpen()) return;  // Cancelled on close
+        checkChunkTimeouts();
+        publishStats();
+        scheduleChunkTimer();
+    });
+}
+
+void NetworkImpl::checkChunkTimeouts() {
+    auto now = ChunkScheduler::Clock::now();
+
+    size_t expired = chunkScheduler.expire(now,
+        std::chrono::milliseconds(CHUNK_RETRY_BACKOFF_MS), CHUNK_MAX_ATTEMPTS);
+    if (expired > 0) {
+        Logger::warning("Network", std::to_string(expired) + " chunk request(s) timed out");
+        chunkWindow.onLoss(now);
+    }
+
+    if (chunkScheduler.pendingCount() < chunkWindow.size() && chunkScheduler.queuedCount() > 0) {
+        processNextChunks();
+    }
+}
+
+void NetworkImpl::updatePeakEventDepth() {
+    // Only the websocket thread writes the peak
+    size_t depth = eventQueue.size();
+    if (depth > peakEventDepth.load(std::memory_order_relaxed)) {
+        peakEventDepth.store(depth, std::memory_order_relaxed);
+    }
+}
+
+void NetworkImpl::dispatchEvents() {
+    eventsDispatched += eventQueue.drain([this](NetworkEvent& event) {
+        switch (event.type) {
+            case NetworkEvent::Type::ChunkLoaded:
+                if (chunkDataCallback) {
+                    chunkDataCallback(event.batch.chunkX, event.batch.chunkY, event.chunkPixels);
+                }
+                // Send back what the callback left, usually the chunk's previous buffer.
+                // If the ring is full it stays in the slot until the slot is refilled.
+                if (event.chunkPixels) {
+                    freeChunkBuffers.tryPush([&event](ChunkPixels& slot) {
+                        slot = std::move(event.chunkPixels);
+                    });
+                }
+                break;
+            case NetworkEvent::Type::PixelBatch:
+                if (pixelBatchCallback) {
+                    pixelBatchCallback(event.batch);
+                }
+                break;
+            case NetworkEvent::Type::Teleport:
+                if (teleportCallback) {
+                    teleportCallback(event.teleportTo.x, event.teleportTo.y);
+                }
+                break;
         }
-    } catch (const std::exception& e) {
-        Logger::error("Network", "Error in processNextChunk: " + std::string(e.what()));
-        std::lock_guard<std::mutex> lock(chunkMutex);
-        waitingForChunk = false;  // Reset state on error
+    });
+}
+
+ConnectionStats NetworkImpl::getConnectionStats() const {
+    ConnectionStats stats;
+    stats.state = state;
+    for (size_t i = 0; i < SESSION_STATE_COUNT; i++) {
+        stats.phaseMs[i] = phaseMs[i].load(std::memory_order_relaxed);
+    }
+    stats.connected = isOpen();
+    stats.reconnecting = stats.state == SessionState::Reconnecting;
+    stats.reconnectAttempt = reconnectAttempt;
+    stats.reconnects = reconnects;
+    stats.tls = useTls;
+    stats.tlsHandshakes = tlsHandshakes;
+    stats.tlsResumptions = tlsResumptions;
+    return stats;
+}
+
+void NetworkImpl::publishStats() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+
+    ChunkPipelineStats& chunks = chunkStatsSnapshot;
+    chunks.chunksPerSecond = chunkWindow.getArrivalRate();
+    chunks.smoothedRttMs = chunkWindow.getSmoothedRttMs();
+    chunks.minRttMs = chunkWindow.getMinRttMs();
+    chunks.inFlight = chunkScheduler.pendingCount();
+    chunks.window = chunkWindow.size();
+    chunks.queued = chunkScheduler.queuedCount();
+    chunks.received = chunksReceived;
+    chunks.cancelled = chunkScheduler.cancelledCount();
+    chunks.timeouts = chunkScheduler.timeoutCount();
+    chunks.retries = chunkScheduler.retryCount();
+    chunks.abandoned = chunkScheduler.abandonedCount();
+
+    for (size_t lane = 0; lane < SEND_LANE_COUNT; lane++) {
+        const LaneCounters& counters = laneCounters[lane];
+        SendLaneStats& out = sendStatsSnapshot.lanes[lane];
+        out.queuedFrames = laneQueues[lane].frameCount();
+        out.queuedBytes = laneQueues[lane].byteCount();
+        out.peakQueuedFrames = counters.peakFrames;
+        out.sent = counters.sent;
+        out.replaced = counters.replaced;
+        out.avgWaitMs = counters.avgWaitMs;
+        out.maxWaitMs = counters.maxWaitMs;
+    }
+}
+
+SendStats NetworkImpl::getSendStats() {
+    SendStats stats;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats = sendStatsSnapshot;
     }
+    stats.bufferedBytes = isOpen() ? lastBufferedAmount.load(std::memory_order_relaxed) : 0;
+    stats.peakBufferedBytes = peakBufferedAmount.load(std::memory_order_relaxed);
+    stats.highWater = SEND_HIGH_WATER_BYTES;
+    stats.flushes = sendFlushes.load(std::memory_order_relaxed);
+    stats.movesSent = cursorSender.sentCount();
+    stats.movesCoalesced = cursorSender.coalescedCount();
+    stats.stalls = sendStalls.load(std::memory_order_relaxed);
+    return stats;
+}
+
+CompressionStats NetworkImpl::getCompressionStats() const {
+    CompressionStats stats;
+    stats.offered = DeflateTraffic::offer;
+    stats.negotiated = isOpen() && deflateNegotiated;
+    stats.messages = messagesIn.load(std::memory_order_relaxed);
+    stats.compressedMessages = compressedMessagesIn.load(std::memory_order_relaxed);
+    stats.payloadBytes = payloadBytesIn.load(std::memory_order_relaxed);
+
+    // Compressed messages count as their compressed size on the wire
+    uint64_t compressed = DeflateTraffic::compressedBytes;
+    uint64_t inflated = DeflateTraffic::inflatedBytes;
+    stats.wireBytes = stats.payloadBytes - std::min(inflated, stats.payloadBytes) + compressed;
+    stats.inflateMs = DeflateTraffic::inflateNanos / 1e6;
+    return stats;
 }
 
-void NetworkImpl::requestChunk(int32_t x, int32_t y) {
-    if (!connected) return;
+EventQueueStats NetworkImpl::getEventQueueStats() const {
+    EventQueueStats stats;
+    stats.depth = eventQueue.size();
+    stats.peakDepth = peakEventDepth.load(std::memory_order_relaxed);
+    stats.capacity = eventQueue.capacity();
+    stats.overflows = eventOverflows.load(std::memory_order_relaxed);
+    stats.dispatched = eventsDispatched;
+    return stats;
+}
 
+ChunkPipelineStats NetworkImpl::getChunkPipelineStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return chunkStatsSnapshot;
+}
+
+void NetworkImpl::requestChunk(const ChunkCoord& coord, SendLane lane) {
     try {
-        // Create chunk request message
-        std::vector<uint8_t> message(9);
-        message[0] = 0x02;  // chunkLoad opcode
-        
-        // Write coordinates in little-endian format
-        std::memcpy(&message[1], &x, sizeof(int32_t));
-        std::memcpy(&message[5], &y, sizeof(int32_t));
-
-        auto con = client.get_con_from_hdl(connection);
-        if (con && con->get_state() == websocketpp::session::state::open) {
-            con->send(message.data(), message.size(), websocketpp::frame::opcode::binary);
-            Logger::info("Network", "Requested chunk at (" + std::to_string(x) + ", " + std::to_string(y) + ")");
-        } else {
-            Logger::error("Network", "Failed to request chunk: connection not ready");
-            std::lock_guard<std::mutex> lock(chunkMutex);
-            pendingChunks.erase(ChunkCoord{x, y});
-            waitingForChunk = false;
+        // Create chunk request message on the stack
+        auto message = protocol::makeChunkRequest(coord.x, coord.y);
+
+        if (!queueFrame(lane, message.data(), message.size())) {
+            chunkScheduler.markFailed(coord);
         }
     } catch (const std::exception& e) {
         Logger::error("Network", "Error requesting chunk: " + std::string(e.what()));
-        std::lock_guard<std::mutex> lock(chunkMutex);
-        pendingChunks.erase(ChunkCoord{x, y});
-        waitingForChunk = false;
+        chunkScheduler.markFailed(coord);
     }
 }
 
-void NetworkImpl::sendBinary(const uint8_t* data, size_t length) {
-    if (!connected || !connection.lock()) return;
-    
-    try {
-        auto con = client.get_con_from_hdl(connection);
-        if (con) {
-            con->send(data, length, websocketpp::frame::opcode::binary);
+void NetworkImpl::moveCursor(int32_t x, int32_t y, const Color& color, uint8_t tool) {
+    if (state != SessionState::InWorld) return;
+
+    // A new session hasn't seen our cursor
+    if (cursorRejoined.exchange(false)) {
+        cursorSender.reset();
+    }
+
+    if (auto message = cursorSender.sample(x, y, color, tool, CursorMoveSender::Clock::now())) {
+        boost::asio::post(io, [this, buffer = *message]() {
+            queueFrame(SendLane::Moves, buffer.data(), buffer.size());
+        });
+    }
+}
+
+bool NetworkImpl::placePixel(int32_t x, int32_t y, const Color& color) {
+    {
+        std::lock_guard<std::mutex> lock(pixelMutex);
+        if (state != SessionState::InWorld) {
+            pixelQueue.countDropped();
+            return false;
         }
-    } catch (const std::exception& e) {
-        Logger::error("Network", "Failed to send binary data: " + std::string(e.what()));
-        // Don't throw here - we want to handle send errors gracefully
+        // The server would reject it; don't draw what would only be rolled back
+        if (rank < static_cast<uint8_t>(Rank::Moderator) &&
+            protectedChunks.count(chunkKey(floorDiv(x, CHUNK_SIZE), floorDiv(y, CHUNK_SIZE))) > 0) {
+            pixelQueue.countDropped();
+            return false;
+        }
+        if (!pixelQueue.push(x, y, color)) {
+            return false;
+        }
+    }
+
+    // Sends happen on the websocket thread
+    boost::asio::post(io, [this]() { flushPixelWrites(); });
+    return true;
+}
+
+void NetworkImpl::flushPixelWrites() {
+    if (!isOpen()) return;
+
+    // Tokens keep accumulating while we wait, up to the bucket size
+    if (sendCongested(SendLane::Pixels)) return;
+
+    PixelWriteQueue::Clock::duration wait;
+    {
+        std::lock_guard<std::mutex> lock(pixelMutex);
+        auto now = PixelWriteQueue::Clock::now();
+        pixelSendBuffer.clear();
+        pixelQueue.popReady(now, pixelSendBuffer);
+        wait = pixelQueue.pendingCount() > 0 && pixelQueue.hasQuota()
+            ? std::max<PixelWriteQueue::Clock::duration>(pixelQueue.timeUntilReady(now),
+                std::chrono::milliseconds(PIXEL_PACING_MIN_MS))
+            : PixelWriteQueue::Clock::duration::zero();
+    }
+
+    // Send outside of mutex lock
+    for (const auto& write : pixelSendBuffer) {
+        auto message = protocol::makePixelUpdate(write.x, write.y, write.color);
+        queueFrame(SendLane::Pixels, message.data(), message.size());
+    }
+
+    // Pace the rest: wake up when the next token is due
+    if (wait > PixelWriteQueue::Clock::duration::zero() && !pixelTimerArmed) {
+        pixelTimerArmed = true;
+        pixelTimer->expires_after(wait);
+        pixelTimer->async_wait([this](const boost::system::error_code& ec) {
+            pixelTimerArmed = false;
+            if (ec) return;  // Cancelled on close
+            flushPixelWrites();
+        });
     }
 }
 
+PixelWriteStats NetworkImpl::getPixelWriteStats() const {
+    std::lock_guard<std::mutex> lock(pixelMutex);
+    PixelWriteStats stats;
+    stats.pending = pixelQueue.pendingCount();
+    stats.sent = pixelQueue.sentCount();
+    stats.coalesced = pixelQueue.coalescedCount();
+    stats.dropped = pixelQueue.droppedCount();
+    stats.tokens = pixelQueue.getTokens();
+    stats.quotaRate = pixelQueue.getQuotaRate();
+    stats.quotaPer = pixelQueue.getQuotaPer();
+    return stats;
+}
+
 void NetworkImpl::sendWorldJoinMessage() {
-    if (!connected) return;
+    if (!isOpen()) return;
 
     Logger::info("Network", "Sending world join message for world: " + worldName);
     
@@ -394,14 +907,10 @@ void NetworkImpl::sendWorldJoinMessage() {
     worldBytes.push_back(0xDD);  // 25565 & 0xFF
     worldBytes.push_back(0x63);  // (25565 >> 8) & 0xFF
 
-    try {
-        auto con = client.get_con_from_hdl(connection);
-        if (con) {
-            con->send(worldBytes.data(), worldBytes.size(), websocketpp::frame::opcode::binary);
-            Logger::info("Network", "Sent world join message");
-        }
-    } catch (const std::exception& e) {
-        Logger::error("Network", "Failed to send world join message: " + std::string(e.what()));
+    if (!queueFrame(SendLane::Control, worldBytes.data(), worldBytes.size())) {
+        Logger::error("Network", "Failed to send world join message: not connected");
+    } else {
+        Logger::info("Network", "Sent world join message");
     }
 }
 
@@ -409,188 +918,223 @@ void NetworkImpl::handleMessage(const std::string& payload) {
     if (payload.empty()) return;
 
     try {
-        // First byte is opcode
-        uint8_t opcode = static_cast<uint8_t>(payload[0]);
-        
-        switch (opcode) {
-            case 0: { // setId
-                if (payload.length() < 5) return;
-                playerId = *reinterpret_cast<const uint32_t*>(payload.data() + 1);
-                Logger::info("Network", "Received player ID: " + std::to_string(playerId));
-                break;
-            }
-            case 1: { // worldUpdate
-                if (payload.length() < 2) return;
-                
-                // Read player count
-                uint8_t playerCount = static_cast<uint8_t>(payload[1]);
-                size_t offset = 2;
-
-                // Process player updates
-                for (uint8_t i = 0; i < playerCount; i++) {
-                    if (offset + 16 > payload.length()) break;
-
-                    uint32_t pid = *reinterpret_cast<const uint32_t*>(payload.data() + offset);
-                    if (pid != playerId) {  // Skip our own updates
-                        int32_t x = *reinterpret_cast<const int32_t*>(payload.data() + offset + 4);
-                        int32_t y = *reinterpret_cast<const int32_t*>(payload.data() + offset + 8);
-                        uint8_t r = static_cast<uint8_t>(payload[offset + 12]);
-                        uint8_t g = static_cast<uint8_t>(payload[offset + 13]);
-                        uint8_t b = static_cast<uint8_t>(payload[offset + 14]);
-                        uint8_t tool = static_cast<uint8_t>(payload[offset + 15]);
-
-                        Player& player = players[pid];
-                        player.x = x;
-                        player.y = y;
-                        player.r = r;
-                        player.g = g;
-                        player.b = b;
-                        player.tool = tool;
-                    }
-                    offset += 16;
-                }
+        auto result = protocol::decode(reinterpret_cast<const uint8_t*>(payload.data()), payload.size(), *this);
+        if (result != protocol::DecodeResult::Ok) {
+            Logger::error("Network", std::string("Dropped server message (opcode ") +
+                std::to_string(static_cast<uint8_t>(payload[0])) + "): " + protocol::toString(result));
+        }
+    } catch (const std::exception& e) {
+        Logger::error("Network", "Error handling message: " + std::string(e.what()));
+    }
+}
 
-                // Process pixel updates
-                if (offset + 2 <= payload.length()) {
-                    uint16_t pixelCount = *reinterpret_cast<const uint16_t*>(payload.data() + offset);
-                    offset += 2;
+void NetworkImpl::onSetId(const protocol::SetIdMessage& msg) {
+    playerId = msg.id;
+    Logger::info("Network", "Received player ID: " + std::to_string(msg.id));
 
-                    for (uint16_t i = 0; i < pixelCount; i++) {
-                        if (offset + 15 > payload.length()) break;
+    // We are in the world: the session is up, so the next drop starts a fresh backoff
+    enterState(SessionState::InWorld);
+    reconnectAttempt = 0;
+    cursorRejoined = true;
+    requestChunksInLastView();
+}
 
-                        uint32_t id = *reinterpret_cast<const uint32_t*>(payload.data() + offset);
-                        int32_t x = *reinterpret_cast<const int32_t*>(payload.data() + offset + 4);
-                        int32_t y = *reinterpret_cast<const int32_t*>(payload.data() + offset + 8);
-                        uint8_t r = static_cast<uint8_t>(payload[offset + 12]);
-                        uint8_t g = static_cast<uint8_t>(payload[offset + 13]);
-                        uint8_t b = static_cast<uint8_t>(payload[offset + 14]);
+void NetworkImpl::onWorldUpdate(const protocol::WorldUpdateMessage& msg) {
+    // Process player updates
+    for (const auto& update : msg.players) {
+        if (update.id == playerId) continue;  // Skip our own updates
 
-                        // TODO: Handle pixel updates
-                        offset += 15;
-                    }
-                }
+        Player& player = players[update.id];
+        player.x = update.x;
+        player.y = update.y;
+        player.r = update.color.r;
+        player.g = update.color.g;
+        player.b = update.color.b;
+        player.tool = update.tool;
+    }
+
+    // Process pixel updates, grouped per chunk
+    if (!msg.pixels.empty()) {
+        // Batches past pixelBatchCount are kept, with their capacity, for later messages
+        pixelBatchCount = 0;
+        pixelBatchIndex.clear();
+        for (const auto& update : msg.pixels) {
+            ChunkCoord coord{floorDiv(update.x, CHUNK_SIZE), floorDiv(update.y, CHUNK_SIZE)};
+
+            // Nothing to update in chunks we don't have
+            if (!chunkScheduler.isLoaded(coord)) continue;
 
-                // Process disconnects
-                if (offset + 1 <= payload.length()) {
-                    uint8_t disconnectCount = static_cast<uint8_t>(payload[offset++]);
-                    for (uint8_t i = 0; i < disconnectCount; i++) {
-                        if (offset + 4 > payload.length()) break;
-                        uint32_t pid = *reinterpret_cast<const uint32_t*>(payload.data() + offset);
-                        players.erase(pid);
-                        offset += 4;
-                    }
+            uint64_t key = chunkKey(coord.x, coord.y);
+            auto inserted = pixelBatchIndex.emplace(key, pixelBatchCount);
+            if (inserted.second) {
+                if (pixelBatchCount == pixelBatches.size()) {
+                    pixelBatches.emplace_back();
                 }
-                break;
+                PixelBatch& batch = pixelBatches[pixelBatchCount++];
+                batch.chunkX = coord.x;
+                batch.chunkY = coord.y;
+                batch.pixels.clear();
             }
-            case 2: { // chunkLoad
-                if (payload.length() < 778) { // 1 byte opcode + 4 bytes x + 4 bytes y + 1 byte locked + 768 bytes data
-                    Logger::error("Network", "Invalid chunk data length: " + std::to_string(payload.length()));
-                    return;
-                }
 
-                // Extract chunk coordinates (4 bytes each)
-                int32_t chunkX = *reinterpret_cast<const int32_t*>(payload.data() + 1);
-                int32_t chunkY = *reinterpret_cast<const int32_t*>(payload.data() + 5);
-                uint8_t locked = static_cast<uint8_t>(payload[9]);
-
-                // Extract chunk data (16x16x3 = 768 bytes)
-                std::vector<Color> chunkData;
-                chunkData.reserve(256); // 16x16 pixels
-
-                const uint8_t* data = reinterpret_cast<const uint8_t*>(payload.data() + 10);
-                for (size_t i = 0; i < 768; i += 3) {
-                    Color pixel;
-                    pixel.r = data[i];
-                    pixel.g = data[i + 1];
-                    pixel.b = data[i + 2];
-                    chunkData.push_back(pixel);
-                }
+            int32_t localX = update.x - coord.x * CHUNK_SIZE;
+            int32_t localY = update.y - coord.y * CHUNK_SIZE;
+            pixelBatches[inserted.first->second].pixels.push_back(
+                PixelBatch::Entry{static_cast<uint8_t>(localY * CHUNK_SIZE + localX), update.color, update.id});
+        }
 
-                bool shouldProcessNext = false;
-                {
-                    std::lock_guard<std::mutex> lock(chunkMutex);
-                    ChunkCoord coord{chunkX, chunkY};
-                    loadedChunks.insert(coord);
-                    pendingChunks.erase(coord);
-                    waitingForChunk = false;
-                    shouldProcessNext = !chunkRequestQueue.empty();
-                }
+        // Hand the batches to the main thread
+        for (size_t i = 0; i < pixelBatchCount; i++) {
+            const PixelBatch& batch = pixelBatches[i];
+            bool queued = eventQueue.tryPush([&batch](NetworkEvent& event) {
+                event.type = NetworkEvent::Type::PixelBatch;
+                event.batch.chunkX = batch.chunkX;
+                event.batch.chunkY = batch.chunkY;
+                event.batch.pixels.assign(batch.pixels.begin(), batch.pixels.end());  // Reuses the slot's capacity
+            });
+            if (!queued) {
+                // The renderer's copy of this chunk is now stale; fetch it again
+                eventOverflows++;
+                refetchChunk(ChunkCoord{batch.chunkX, batch.chunkY});
+            }
+        }
+        updatePeakEventDepth();
 
-                // Call the callback outside of mutex lock
-                if (chunkDataCallback) {
-                    chunkDataCallback(chunkX, chunkY, chunkData);
-                }
+        if (chunkScheduler.pendingCount() < chunkWindow.size() && chunkScheduler.queuedCount() > 0) {
+            processNextChunks();
+        }
+    }
 
-                // Process next chunk if needed
-                if (shouldProcessNext) {
-                    processNextChunk();
-                }
+    // Process disconnects
+    for (uint32_t pid : msg.disconnects) {
+        players.erase(pid);
+    }
 
-                Logger::info("Network", "Received chunk data for (" + std::to_string(chunkX) + ", " + 
-                    std::to_string(chunkY) + ")");
-                break;
-            }
-            case 3: { // teleport
-                if (payload.length() < 9) return;
-                int32_t x = *reinterpret_cast<const int32_t*>(payload.data() + 1);
-                int32_t y = *reinterpret_cast<const int32_t*>(payload.data() + 5);
-                // TODO: Handle teleport
-                break;
-            }
-            case 4: { // setRank
-                if (payload.length() < 2) return;
-                uint8_t rank = static_cast<uint8_t>(payload[1]);
-                // TODO: Handle rank update
-                break;
-            }
-            case 5: { // captcha
-                if (payload.length() < 2) return;
-                uint8_t captchaState = static_cast<uint8_t>(payload[1]);
-                
-                switch (captchaState) {
-                    case 0: // CA_WAITING
-                        Logger::info("Network", "Received captcha state: WAITING (0)");
-                        waitingForCaptcha = true;
-                        break;
-                    case 1: // CA_VERIFYING
-                        Logger::info("Network", "Received captcha state: VERIFYING (1)");
-                        break;
-                    case 2: // CA_VERIFIED
-                        Logger::info("Network", "Received captcha state: VERIFIED (2)");
-                        waitingForCaptcha = false;
-                        break;
-                    case 3: // CA_OK
-                        Logger::info("Network", "Received captcha state: OK (3)");
-                        waitingForCaptcha = false;
-                        // Send world join message after successful captcha
-                        sendWorldJoinMessage();
-                        break;
-                    case 4: // CA_INVALID
-                        Logger::info("Network", "Received captcha state: INVALID (4)");
-                        waitingForCaptcha = true;
-                        break;
-                }
-                break;
-            }
-            case 6: { // setPQuota
-                // TODO: Handle pixel quota update
-                break;
-            }
-            case 7: { // chunkProtected
-                if (payload.length() < 10) return;
-                int32_t x = *reinterpret_cast<const int32_t*>(payload.data() + 1);
-                int32_t y = *reinterpret_cast<const int32_t*>(payload.data() + 5);
-                uint8_t state = static_cast<uint8_t>(payload[9]);
-                // TODO: Handle chunk protection update
-                break;
-            }
+    if (!msg.players.empty() || !msg.disconnects.empty()) {
+        publishPlayerSnapshot();
+    }
+}
+
+void NetworkImpl::publishPlayerSnapshot() {
+    auto snapshot = std::make_shared<PlayerSnapshot>();
+    snapshot->sequence = ++playerSequence;
+    snapshot->receivedAt = std::chrono::steady_clock::now();
+    snapshot->players = players;
+
+    // Readers holding an older snapshot keep it alive until they let go
+    playerSnapshots.back() = std::move(snapshot);
+    playerSnapshots.publish();
+}
+
+void NetworkImpl::onChunkLoad(const protocol::ChunkLoadMessage& msg) {
+    // Copy the chunk data (16x16x3 = 768 bytes) into a buffer the main thread
+    // sent back, which travels through the queue by pointer and is adopted by
+    // the renderer as is
+    bool queued = eventQueue.tryPush([this, &msg](NetworkEvent& event) {
+        event.type = NetworkEvent::Type::ChunkLoaded;
+        event.batch.chunkX = msg.x;
+        event.batch.chunkY = msg.y;
+        if (!event.chunkPixels) {
+            freeChunkBuffers.tryPop([&event](ChunkPixels& slot) {
+                event.chunkPixels = std::move(slot);
+            });
         }
-    } catch (const std::exception& e) {
-        Logger::error("Network", "Error handling message: " + std::string(e.what()));
-        
-        // Reset chunk state on error
-        std::lock_guard<std::mutex> lock(chunkMutex);
-        waitingForChunk = false;
+        if (!event.chunkPixels) {
+            event.chunkPixels = std::make_unique<ChunkPixelBuffer>();
+        }
+        std::memcpy(event.chunkPixels->data(), msg.pixels.rgb, CHUNK_PIXEL_BYTES);
+    });
+    if (queued) {
+        updatePeakEventDepth();
+    } else {
+        eventOverflows++;
+    }
+
+    chunksReceived++;
+    setChunkProtected(msg.x, msg.y, msg.locked);
+
+    ChunkCoord coord{msg.x, msg.y};
+    ChunkScheduler::Clock::time_point sentAt;
+    if (!queued) {
+        // Main thread is too far behind; request the chunk again
+        refetchChunk(coord);
+    } else if (chunkScheduler.markLoaded(coord, sentAt)) {
+        // Feed the RTT of the matching request into the window
+        auto now = ChunkScheduler::Clock::now();
+        chunkWindow.onResponse(now - sentAt, now, chunkScheduler.queuedCount() == 0);
+    }
+
+    // Refill the window if needed
+    if (chunkScheduler.queuedCount() > 0) {
+        processNextChunks();
+    }
+}
+
+void NetworkImpl::onTeleport(const protocol::TeleportMessage& msg) {
+    Logger::info("Network", "Teleported to (" + std::to_string(msg.x) + ", " + std::to_string(msg.y) + ")");
+
+    // The main thread moves the camera, which requests the chunks there
+    bool queued = eventQueue.tryPush([&msg](NetworkEvent& event) {
+        event.type = NetworkEvent::Type::Teleport;
+        event.teleportTo = Vec2i(msg.x, msg.y);
+    });
+    if (queued) {
+        updatePeakEventDepth();
+    } else {
+        eventOverflows++;
+    }
+}
+
+void NetworkImpl::onSetRank(const protocol::SetRankMessage& msg) {
+    rank = msg.rank;
+    Logger::info("Network", "Received rank: " + std::to_string(msg.rank));
+}
+
+void NetworkImpl::onCaptcha(const protocol::CaptchaMessage& msg) {
+    switch (msg.state) {
+        case protocol::CaptchaState::Waiting:
+            Logger::info("Network", "Received captcha state: WAITING (0)");
+            break;
+        case protocol::CaptchaState::Verifying:
+            Logger::info("Network", "Received captcha state: VERIFYING (1)");
+            break;
+        case protocol::CaptchaState::Verified:
+            Logger::info("Network", "Received captcha state: VERIFIED (2)");
+            break;
+        case protocol::CaptchaState::Ok:
+            Logger::info("Network", "Received captcha state: OK (3)");
+            // Send world join message after successful captcha
+            if (state == SessionState::Captcha) {
+                enterState(SessionState::Joining);
+                sendWorldJoinMessage();
+            }
+            break;
+        case protocol::CaptchaState::Invalid:
+            Logger::info("Network", "Received captcha state: INVALID (4)");
+            break;
+    }
+}
+
+void NetworkImpl::onSetPQuota(const protocol::SetPQuotaMessage& msg) {
+    Logger::info("Network", "Pixel quota: " + std::to_string(msg.rate) + " per " + std::to_string(msg.per) + "s");
+    {
+        std::lock_guard<std::mutex> lock(pixelMutex);
+        pixelQueue.setQuota(msg.rate, msg.per, PixelWriteQueue::Clock::now());
+    }
+
+    // Writes may have been waiting for the first quota
+    flushPixelWrites();
+}
+
+void NetworkImpl::onChunkProtected(const protocol::ChunkProtectedMessage& msg) {
+    setChunkProtected(msg.x, msg.y, msg.locked);
+}
+
+void NetworkImpl::setChunkProtected(int32_t chunkX, int32_t chunkY, bool locked) {
+    std::lock_guard<std::mutex> lock(pixelMutex);
+    if (locked) {
+        protectedChunks.insert(chunkKey(chunkX, chunkY));
+    } else {
+        protectedChunks.erase(chunkKey(chunkX, chunkY));
     }
 }
 
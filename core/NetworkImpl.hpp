@@ -3,80 +3,268 @@
 #include <owop-client/CaptchaServer.hpp>
 #include <owop-client/Types.hpp>
 #include <owop-client/Player.hpp>
+#include <owop-client/NetworkStats.hpp>
+#include <owop-client/ProtocolDecoder.hpp>
+#include <owop-client/SpscRing.hpp>
+#include <owop-client/TripleBuffer.hpp>
+#include "ChunkWindow.hpp"
+#include "ChunkScheduler.hpp"
+#include "PixelWriteQueue.hpp"
+#include "FrameQueue.hpp"
+#include "CursorMoveSender.hpp"
 #include <memory>
 #include <string>
 #include <vector>
 #include <functional>
 #include <unordered_map>
+#include <unordered_set>
+#include <array>
 #include <thread>
-#include <queue>
-#include <set>
 #include <mutex>
 #include <atomic>
+#include <random>
+#include <chrono>
 
 namespace owop {
 
-// Helper struct for chunk coordinates
-struct ChunkCoord {
-    int32_t x;
-    int32_t y;
+// Decoded data handed from the websocket thread to the main thread
+struct NetworkEvent {
+    enum class Type : uint8_t {
+        ChunkLoaded,
+        PixelBatch,
+        Teleport
+    };
 
-    bool operator==(const ChunkCoord& other) const {
-        return x == other.x && y == other.y;
-    }
-
-    bool operator<(const ChunkCoord& other) const {
-        return x < other.x || (x == other.x && y < other.y);
-    }
+    Type type;
+    PixelBatch batch;  // chunkX/chunkY for chunk events, pixels for PixelBatch only
+    Vec2i teleportTo;  // Teleport only, in world pixels
+    ChunkPixels chunkPixels;  // ChunkLoaded only; may be taken by the chunk callback
 };
 
-class NetworkImpl {
+// The session is a state machine (see SessionState) driven entirely on the
+// websocket thread. That thread is the only one running io, so everything it
+// owns - the state, the chunk scheduler, the send lanes - needs no lock; other
+// threads post work to it and read published snapshots.
+class NetworkImpl : private protocol::MessageHandler {
 public:
     NetworkImpl(std::unique_ptr<CaptchaServer>* captchaServer);
     ~NetworkImpl() {
         disconnect();  // Ensure clean shutdown
+
+        // Let the websocket thread finish the close handshake, then exit for good
+        ioWork.reset();
+        if (websocketThread.joinable()) {
+            websocketThread.join();
+        }
+        if (tlsSession) {
+            SSL_SESSION_free(tlsSession);
+        }
     }
 
+    // connect, disconnect, submitCaptcha and requestChunksInView post to the
+    // websocket thread and return immediately
     void connect(const std::string& url, const std::string& world);
     void disconnect();
     void submitCaptcha(const std::string& token);
-    void requestChunksInView(int32_t centerX, int32_t centerY, float zoom);
-    bool isWaitingForCaptcha() const { return waitingForCaptcha; }
-    const std::unordered_map<uint32_t, Player>& getPlayers() const { return players; }
+    void requestChunksInView(int32_t centerX, int32_t centerY, float zoom, int viewportWidth, int viewportHeight);
+    void forgetChunks(const std::vector<Vec2i>& chunks);  // Posts to the websocket thread
+    bool isWaitingForCaptcha() const {
+        SessionState current = state;
+        return current == SessionState::Connecting || current == SessionState::Captcha;
+    }
+    uint32_t getPlayerId() const { return playerId; }
+    // Latest published player snapshot; never null. Main thread only.
+    PlayerSnapshotPtr getPlayers() const { return playerSnapshots.read(); }
+    ChunkPipelineStats getChunkPipelineStats() const;
+    EventQueueStats getEventQueueStats() const;
+    ConnectionStats getConnectionStats() const;
+    CompressionStats getCompressionStats() const;
+    SendStats getSendStats();  // Main thread
+    PixelWriteStats getPixelWriteStats() const;
+
+    // Queue a pixel for placement; sent as the server's pixel quota allows.
+    // Returns false if the write was dropped.
+    bool placePixel(int32_t x, int32_t y, const Color& color);
+
+    // Main thread, every frame: our cursor in 1/16 pixel units. Sent at most once
+    // per server tick when it changed pixel, in the lowest lane.
+    void moveCursor(int32_t x, int32_t y, const Color& color, uint8_t tool);
 
-    void setChunkDataCallback(std::function<void(int, int, const std::vector<Color>&)> callback) {
+    // Main thread: run the chunk and pixel callbacks for everything received since the last call
+    void dispatchEvents();
+
+    void setChunkDataCallback(std::function<void(int, int, ChunkPixels&)> callback) {
         chunkDataCallback = callback;
     }
 
+    void setPixelBatchCallback(std::function<void(const PixelBatch&)> callback) {
+        pixelBatchCallback = callback;
+    }
+
+    void setTeleportCallback(std::function<void(int32_t, int32_t)> callback) {
+        teleportCallback = callback;
+    }
+
 private:
+    // Websocket thread only
+    void enterState(SessionState next);
+    bool isOpen() const {
+        SessionState current = state;
+        return current == SessionState::Captcha || current == SessionState::Joining || current == SessionState::InWorld;
+    }
+    void startWebsocketThread();
+    void resetSession();
+    void publishStats();
+    void sendCaptchaToken(const std::string& token);
+
     void handleMessage(const std::string& payload);
-    void requestChunk(int32_t x, int32_t y);
-    void sendBinary(const uint8_t* data, size_t length);
+
+    // protocol::MessageHandler
+    void onSetId(const protocol::SetIdMessage& msg) override;
+    void onWorldUpdate(const protocol::WorldUpdateMessage& msg) override;
+    void onChunkLoad(const protocol::ChunkLoadMessage& msg) override;
+    void onTeleport(const protocol::TeleportMessage& msg) override;
+    void onSetRank(const protocol::SetRankMessage& msg) override;
+    void onCaptcha(const protocol::CaptchaMessage& msg) override;
+    void onSetPQuota(const protocol::SetPQuotaMessage& msg) override;
+    void onChunkProtected(const protocol::ChunkProtectedMessage& msg) override;
+    void setChunkProtected(int32_t chunkX, int32_t chunkY, bool locked);
+
+    void requestChunk(const ChunkCoord& coord, SendLane lane);
     void sendWorldJoinMessage();
     void attemptConnection();
-    void processNextChunk();
-    bool isChunkQueued(const ChunkCoord& coord) const;
+    template<typename Client> void initClient(Client& endpoint);
+    template<typename Client> bool startConnection(Client& endpoint);
+    websocketpp::lib::error_code sendFrame(const void* data, size_t length, websocketpp::frame::opcode::value opcode);
+    bool queueFrame(SendLane lane, const void* data, size_t length, bool text = false);
+    void flushOutbound();
+    size_t bufferedAmount();
+    bool sendCongested(SendLane lane);
+    void waitForSendRoom();
+    void closeConnection(const std::string& reason);
+    void saveTlsSession(SSL* ssl);
+    void handleConnectionLost();
+    void scheduleReconnect();
+    void requestChunksInLastView();
+    void enqueueChunksInView(int32_t centerX, int32_t centerY, float zoom, int viewportWidth, int viewportHeight);
+    void processNextChunks();
+    void refetchChunk(const ChunkCoord& coord);  // After its update was dropped
+    void updatePeakEventDepth();
+    void scheduleChunkTimer();
+    void checkChunkTimeouts();
+    void publishPlayerSnapshot();
+    void flushPixelWrites();
+
+    // Both endpoints run on one io_context and one thread; useTls says which owns the connection
+    boost::asio::io_context io;
+    std::unique_ptr<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> ioWork;
+    WebSocketTlsClient tlsClient;
+    WebSocketPlainClient plainClient;
+    std::atomic<bool> useTls{true};
 
-    WebSocketClient client;
+    // Built once and reused for every handshake, so reconnects can resume the TLS session
+    std::shared_ptr<boost::asio::ssl::context> tlsContext;
+    SSL_SESSION* tlsSession{nullptr};  // Last session from the server, websocket thread only
+    std::atomic<uint64_t> tlsHandshakes{0};
+    std::atomic<uint64_t> tlsResumptions{0};
+    // Inbound traffic; the deflate side is counted in DeflateTraffic
+    std::atomic<bool> deflateNegotiated{false};
+    std::atomic<uint64_t> messagesIn{0};
+    std::atomic<uint64_t> compressedMessagesIn{0};
+    std::atomic<uint64_t> payloadBytesIn{0};  // After inflating
+
+    std::unique_ptr<boost::asio::steady_timer> chunkTimer;  // Runs on the client's io_service
+    std::unique_ptr<boost::asio::steady_timer> pixelTimer;  // Wakes the pixel queue when the next token is due
+    std::unique_ptr<boost::asio::steady_timer> reconnectTimer;
+    std::unique_ptr<boost::asio::steady_timer> sendRetryTimer;  // Wakes held-back senders
     WebSocketConnection connection;
-    bool connected{false};
-    bool connecting{false};
-    bool waitingForCaptcha{false};
-    std::string worldName;
-    std::string serverUrl;
+    uint64_t connectionGeneration{0};  // Websocket thread only; bumped per attempt and by disconnect()
+
+    // Session state; written on the websocket thread only, read anywhere
+    std::atomic<SessionState> state{SessionState::Idle};
+    std::chrono::steady_clock::time_point stateEnteredAt;  // Websocket thread only
+    std::atomic<double> phaseMs[SESSION_STATE_COUNT] = {};  // Time spent on the last pass through each state
+
+    // Automatic reconnect
+    bool userDisconnected{false};           // Set by disconnect(); suppresses reconnecting
+    std::atomic<int> reconnectAttempt{0};   // Attempts since the last successful world join
+    std::atomic<uint64_t> reconnects{0};
+    std::mt19937 reconnectRng{std::random_device{}()};
+    std::string worldName;   // Websocket thread only
+    std::string serverUrl;   // Websocket thread only
     std::unique_ptr<CaptchaServer>* captchaServer;
-    std::string pendingToken;
-    uint32_t playerId{0};
-    std::unordered_map<uint32_t, Player> players;
-    std::function<void(int, int, const std::vector<Color>&)> chunkDataCallback;
+    std::string pendingToken;  // Websocket thread only
+    std::atomic<uint32_t> playerId{0};
+    std::atomic<uint8_t> rank{0};
+    std::unordered_map<uint32_t, Player> players;  // Websocket thread only
+    // Written on the websocket thread, read on the main thread. Only the pointer
+    // goes through the buffer; readers keep the snapshot alive while they use it.
+    mutable TripleBuffer<PlayerSnapshotPtr> playerSnapshots;
+    uint64_t playerSequence{0};  // Websocket thread only
+    std::function<void(int, int, ChunkPixels&)> chunkDataCallback;
+    std::function<void(const PixelBatch&)> pixelBatchCallback;
+    std::function<void(int32_t, int32_t)> teleportCallback;
+    std::vector<PixelBatch> pixelBatches;  // Reused, with their pixel buffers, for every worldUpdate
+    size_t pixelBatchCount{0};             // Batches in use for the current worldUpdate
+    std::unordered_map<uint64_t, size_t> pixelBatchIndex;  // Chunk key -> index in pixelBatches
+
+    // Websocket thread -> main thread handoff
+    SpscRing<NetworkEvent, NETWORK_EVENT_QUEUE_SIZE> eventQueue;
+    SpscRing<ChunkPixels, NETWORK_EVENT_QUEUE_SIZE> freeChunkBuffers;  // Main thread -> websocket thread, for reuse
+    std::atomic<size_t> peakEventDepth{0};
+    std::atomic<uint64_t> eventOverflows{0};
+    uint64_t eventsDispatched{0};  // Main thread only
     std::thread websocketThread;
 
-    // Chunk management
-    std::queue<ChunkCoord> chunkRequestQueue;
-    std::set<ChunkCoord> loadedChunks;
-    std::set<ChunkCoord> pendingChunks;  // Chunks that have been requested but not yet received
-    std::mutex chunkMutex;
-    std::atomic<bool> waitingForChunk{false};  // True if waiting for a chunk response
+    // Chunk management, websocket thread only
+    ChunkScheduler chunkScheduler;  // Queued, pending and loaded chunks
+    ChunkWindow chunkWindow;  // Limits how many requests may be pending at once
+    uint64_t chunksReceived{0};
+
+    struct ViewRequest {
+        int32_t centerX = 0;
+        int32_t centerY = 0;
+        float zoom = 0.0f;
+        int viewportWidth = 0;
+        int viewportHeight = 0;
+        bool valid = false;
+    };
+    ViewRequest lastView;
+    ChunkRect visibleArea{0, 0, -1, -1};  // Requests outside it use the prefetch lane
+
+    // Own cursor
+    CursorMoveSender cursorSender;  // Main thread only
+    std::atomic<bool> cursorRejoined{false};  // Set on setId; the next sample is sent regardless
+
+    // Pixel placement
+    PixelWriteQueue pixelQueue;  // Filled by the main thread, drained on the websocket thread
+    std::vector<PixelWrite> pixelSendBuffer;  // Websocket thread only
+    bool pixelTimerArmed{false};  // Websocket thread only
+    std::unordered_set<uint64_t> protectedChunks;  // Chunk keys only moderators may paint; guarded by pixelMutex
+    mutable std::mutex pixelMutex;
+
+    // Outbound frames, one queue per SendLane, written in lane order. Websocket thread only.
+    struct LaneCounters {
+        size_t peakFrames = 0;
+        uint64_t sent = 0;
+        uint64_t replaced = 0;
+        double avgWaitMs = 0.0;
+        double maxWaitMs = 0.0;
+    };
+    FrameQueue laneQueues[SEND_LANE_COUNT];
+    LaneCounters laneCounters[SEND_LANE_COUNT];
+    bool flushPosted{false};
+    bool sendRetryArmed{false};
+    std::atomic<size_t> lastBufferedAmount{0};  // As of the last flush
+    std::atomic<size_t> peakBufferedAmount{0};
+    std::atomic<uint64_t> sendFlushes{0};
+    std::atomic<uint64_t> sendStalls{0};
+
+    // Copies of the websocket thread's chunk and lane state for other threads,
+    // refreshed on every chunk timer tick and state change
+    ChunkPipelineStats chunkStatsSnapshot;  // Guarded by statsMutex
+    SendStats sendStatsSnapshot;            // Guarded by statsMutex; lanes only
+    mutable std::mutex statsMutex;
 }; 
 
 } // namespace owop
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include <owop-client/PendingPixelWrites.hpp>
+#include <cmath>
+
+namespace owop {
+
+namespace {
+    bool sameColor(const Color& a, const Color& b) {
+        return a.r == b.r && a.g == b.g && a.b == b.b;
+    }
+}
+
+void LatencyHistogram::record(double ms) {
+    size_t bucket = 0;
+    if (ms >= 1.0) {
+        bucket = static_cast<size_t>(std::log2(ms));
+        if (bucket >= BUCKET_COUNT) {
+            bucket = BUCKET_COUNT - 1;
+        }
+    }
+    buckets[bucket]++;
+    count++;
+}
+
+double LatencyHistogram::percentile(double fraction) const {
+    if (count == 0) return 0.0;
+
+    uint64_t target = static_cast<uint64_t>(std::ceil(fraction * count));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += buckets[i];
+        if (seen >= target) {
+            return std::ldexp(1.0, static_cast<int>(i) + 1);
+        }
+    }
+    return std::ldexp(1.0, static_cast<int>(BUCKET_COUNT));
+}
+
+void PendingPixelWrites::add(int32_t x, int32_t y, const Color& placed, const Color& previous, Clock::time_point now) {
+    auto inserted = writes.emplace(key(x, y), Write{placed, previous, now});
+    if (!inserted.second) {
+        // Painting over our own pending write: keep the color from the server underneath
+        inserted.first->second.placed = placed;
+        inserted.first->second.placedAt = now;
+    }
+}
+
+bool PendingPixelWrites::onServerUpdate(int32_t x, int32_t y, const Color& color, bool fromUs,
+                                        Clock::time_point now, Color& display) {
+    auto it = writes.find(key(x, y));
+    if (it == writes.end()) return false;
+
+    Write& write = it->second;
+    if (fromUs && sameColor(color, write.placed)) {
+        latency.record(std::chrono::duration<double, std::milli>(now - write.placedAt).count());
+        confirmed++;
+        writes.erase(it);
+        return false;
+    }
+
+    // Someone else's write, or an older one of ours, landed first; ours is still on its way
+    write.previous = color;
+    display = write.placed;
+    return true;
+}
+
+size_t PendingPixelWrites::expire(Clock::time_point now, Clock::time_point busySince, Clock::duration timeout,
+                                  const RollbackFn& rollback) {
+    size_t expired = 0;
+    for (auto it = writes.begin(); it != writes.end();) {
+        Clock::time_point since = it->second.placedAt > busySince ? it->second.placedAt : busySince;
+        if (now - since < timeout) {
+            ++it;
+            continue;
+        }
+
+        rollback(static_cast<int32_t>(static_cast<uint32_t>(it->first >> 32)),
+                 static_cast<int32_t>(static_cast<uint32_t>(it->first)),
+                 it->second.previous);
+        it = writes.erase(it);
+        rolledBack++;
+        expired++;
+    }
+    return expired;
+}
+
+} // namespace owop
@@ -0,0 +1,114 @@
+#include "PixelWriteQueue.hpp"
+#include <owop-client/Constants.hpp>
+#include <algorithm>
+
+namespace owop {
+
+PixelWriteQueue::PixelWriteQueue()
+    : quotaRate(0)
+    , quotaPer(0)
+    , capacity(0.0)
+    , tokensPerSecond(0.0)
+    , tokens(0.0)
+    , sent(0)
+    , coalesced(0)
+    , dropped(0)
+{
+}
+
+void PixelWriteQueue::setQuota(uint16_t rate, uint16_t per, Clock::time_point now) {
+    if (hasQuota()) {
+        // Resent mid-session (rank change, rejoin): the server's bucket keeps its
+        // level, so refilling ours would allow a second burst. Bring it up to now
+        // at the old rate, then fit it to the new size.
+        refill(now);
+        tokens = std::min(tokens, static_cast<double>(rate));
+    } else {
+        tokens = rate;
+        lastRefill = now;
+    }
+
+    quotaRate = rate;
+    quotaPer = per;
+    capacity = rate;
+    tokensPerSecond = rate * PIXEL_QUOTA_MARGIN / std::max<uint16_t>(per, 1);
+}
+
+bool PixelWriteQueue::push(int32_t x, int32_t y, const Color& color) {
+    uint64_t k = key(x, y);
+    auto it = colors.find(k);
+    if (it != colors.end()) {
+        it->second = color;
+        coalesced++;
+        return true;
+    }
+
+    if (order.size() >= PIXEL_QUEUE_MAX) {
+        dropped++;
+        return false;
+    }
+
+    colors.emplace(k, color);
+    order.push_back(k);
+    return true;
+}
+
+void PixelWriteQueue::refill(Clock::time_point now) {
+    double elapsed = std::chrono::duration<double>(now - lastRefill).count();
+    lastRefill = now;
+    if (elapsed > 0.0) {
+        tokens = std::min(capacity, tokens + elapsed * tokensPerSecond);
+    }
+}
+
+size_t PixelWriteQueue::popReady(Clock::time_point now, std::vector<PixelWrite>& out) {
+    if (!hasQuota()) return 0;
+    refill(now);
+
+    size_t count = 0;
+    while (!order.empty() && tokens >= 1.0) {
+        uint64_t k = order.front();
+        order.pop_front();
+
+        auto it = colors.find(k);
+        out.push_back(PixelWrite{
+            static_cast<int32_t>(static_cast<uint32_t>(k >> 32)),
+            static_cast<int32_t>(static_cast<uint32_t>(k)),
+            it->second
+        });
+        colors.erase(it);
+
+        tokens -= 1.0;
+        sent++;
+        count++;
+    }
+    return count;
+}
+
+PixelWriteQueue::Clock::duration PixelWriteQueue::timeUntilReady(Clock::time_point now) {
+    if (order.empty() || !hasQuota() || tokensPerSecond <= 0.0) {
+        return Clock::duration::zero();
+    }
+
+    refill(now);
+    if (tokens >= 1.0) {
+        return Clock::duration::zero();
+    }
+
+    // Round up so the token is really there when the caller wakes
+    return std::chrono::ceil<Clock::duration>(
+        std::chrono::duration<double>((1.0 - tokens) / tokensPerSecond));
+}
+
+void PixelWriteQueue::clear() {
+    dropped += order.size();
+    order.clear();
+    colors.clear();
+    quotaRate = 0;
+    quotaPer = 0;
+    capacity = 0.0;
+    tokensPerSecond = 0.0;
+    tokens = 0.0;
+}
+
+} // namespace owop
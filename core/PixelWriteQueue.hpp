@@ -0,0 +1,80 @@
+#pragma once
+#include <owop-client/Types.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+namespace owop {
+
+struct PixelWrite {
+    int32_t x;
+    int32_t y;
+    Color color;
+};
+
+// Outbound pixel writes waiting for quota. A token bucket mirrors the server's
+// setPQuota (rate pixels every per seconds) so we never send faster than the
+// server allows. Writes to a pixel that is still queued replace its color in
+// place, so only the last color is sent and the pixel keeps its place in line.
+// Not thread-safe: NetworkImpl guards it with pixelMutex.
+class PixelWriteQueue {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    PixelWriteQueue();
+
+    // Apply a quota from the server. The first one since clear() starts the
+    // bucket full, like the server's; later ones keep the current level.
+    void setQuota(uint16_t rate, uint16_t per, Clock::time_point now);
+    bool hasQuota() const { return capacity > 0.0; }
+
+    // Queue a write, or update the color of a queued write to the same pixel.
+    // Returns false (and counts a drop) if the queue is full.
+    bool push(int32_t x, int32_t y, const Color& color);
+
+    // Append as many writes as the bucket allows right now, oldest first
+    size_t popReady(Clock::time_point now, std::vector<PixelWrite>& out);
+
+    // Time until the next write can go out; zero if one can go now or nothing is queued
+    Clock::duration timeUntilReady(Clock::time_point now);
+
+    // Drop everything queued and forget the quota
+    void clear();
+
+    size_t pendingCount() const { return order.size(); }
+    double getTokens() const { return tokens; }
+    uint16_t getQuotaRate() const { return quotaRate; }
+    uint16_t getQuotaPer() const { return quotaPer; }
+    uint64_t sentCount() const { return sent; }
+    uint64_t coalescedCount() const { return coalesced; }
+    uint64_t droppedCount() const { return dropped; }
+
+    // Count a write that was rejected before reaching the queue
+    void countDropped() { dropped++; }
+
+private:
+    static uint64_t key(int32_t x, int32_t y) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+    }
+
+    void refill(Clock::time_point now);
+
+    std::deque<uint64_t> order;                 // Pixels in the order they were first written
+    std::unordered_map<uint64_t, Color> colors; // Latest color per queued pixel
+
+    uint16_t quotaRate;
+    uint16_t quotaPer;
+    double capacity;         // Bucket size in pixels
+    double tokensPerSecond;
+    double tokens;
+    Clock::time_point lastRefill;
+
+    uint64_t sent;
+    uint64_t coalesced;
+    uint64_t dropped;
+};
+
+} // namespace owop
@@ -0,0 +1,142 @@
+#include <owop-client/ProtocolDecoder.hpp>
+
+namespace owop {
+namespace protocol {
+
+namespace {
+
+using DecodeFn = DecodeResult (*)(const uint8_t* data, size_t length, MessageHandler& handler);
+
+struct OpcodeEntry {
+    size_t minLength;  // Including the opcode byte
+    DecodeFn decode;
+};
+
+DecodeResult decodeSetId(const uint8_t* data, size_t, MessageHandler& handler) {
+    handler.onSetId(SetIdMessage{SetIdLayout::field<0>(data)});
+    return DecodeResult::Ok;
+}
+
+DecodeResult decodeWorldUpdate(const uint8_t* data, size_t length, MessageHandler& handler) {
+    WorldUpdateMessage msg;
+    size_t offset = 1;
+
+    // Player updates: u8 count, 16 bytes each
+    size_t playerCount = data[offset++];
+    if (offset + playerCount * decltype(msg.players)::RECORD_SIZE > length) return DecodeResult::Malformed;
+    msg.players = decltype(msg.players)(data + offset, playerCount);
+    offset += playerCount * decltype(msg.players)::RECORD_SIZE;
+
+    // Pixel updates: u16 count, 15 bytes each (section may be omitted)
+    if (offset + 2 <= length) {
+        size_t pixelCount = wire::readLE<uint16_t>(data + offset);
+        offset += 2;
+        if (offset + pixelCount * decltype(msg.pixels)::RECORD_SIZE > length) return DecodeResult::Malformed;
+        msg.pixels = decltype(msg.pixels)(data + offset, pixelCount);
+        offset += pixelCount * decltype(msg.pixels)::RECORD_SIZE;
+    }
+
+    // Disconnects: u8 count, 4 bytes each (section may be omitted)
+    if (offset + 1 <= length) {
+        size_t disconnectCount = data[offset++];
+        if (offset + disconnectCount * decltype(msg.disconnects)::RECORD_SIZE > length) return DecodeResult::Malformed;
+        msg.disconnects = decltype(msg.disconnects)(data + offset, disconnectCount);
+    }
+
+    handler.onWorldUpdate(msg);
+    return DecodeResult::Ok;
+}
+
+DecodeResult decodeChunkLoad(const uint8_t* data, size_t, MessageHandler& handler) {
+    using L = ChunkLoadHeaderLayout;
+    ChunkLoadMessage msg;
+    msg.x = L::field<0>(data);
+    msg.y = L::field<1>(data);
+    msg.locked = L::field<2>(data) != 0;
+    msg.pixels = ChunkPixelsView{data + L::SIZE};
+    handler.onChunkLoad(msg);
+    return DecodeResult::Ok;
+}
+
+DecodeResult decodeTeleport(const uint8_t* data, size_t, MessageHandler& handler) {
+    handler.onTeleport(TeleportMessage{TeleportLayout::field<0>(data), TeleportLayout::field<1>(data)});
+    return DecodeResult::Ok;
+}
+
+DecodeResult decodeSetRank(const uint8_t* data, size_t, MessageHandler& handler) {
+    handler.onSetRank(SetRankMessage{SetRankLayout::field<0>(data)});
+    return DecodeResult::Ok;
+}
+
+DecodeResult decodeCaptcha(const uint8_t* data, size_t, MessageHandler& handler) {
+    uint8_t state = CaptchaLayout::field<0>(data);
+    if (state > static_cast<uint8_t>(CaptchaState::Invalid)) return DecodeResult::Malformed;
+    handler.onCaptcha(CaptchaMessage{static_cast<CaptchaState>(state)});
+    return DecodeResult::Ok;
+}
+
+DecodeResult decodeSetPQuota(const uint8_t* data, size_t, MessageHandler& handler) {
+    handler.onSetPQuota(SetPQuotaMessage{SetPQuotaLayout::field<0>(data), SetPQuotaLayout::field<1>(data)});
+    return DecodeResult::Ok;
+}
+
+DecodeResult decodeChunkProtected(const uint8_t* data, size_t, MessageHandler& handler) {
+    using L = ChunkProtectedLayout;
+    handler.onChunkProtected(ChunkProtectedMessage{L::field<0>(data), L::field<1>(data), L::field<2>(data) != 0});
+    return DecodeResult::Ok;
+}
+
+DecodeResult decodeMaxCount(const uint8_t* data, size_t, MessageHandler& handler) {
+    handler.onMaxCount(MaxCountMessage{MaxCountLayout::field<0>(data)});
+    return DecodeResult::Ok;
+}
+
+DecodeResult decodeDonationUntil(const uint8_t* data, size_t, MessageHandler& handler) {
+    handler.onDonationUntil(DonationUntilMessage{DonationUntilLayout::field<0>(data), DonationUntilLayout::field<1>(data)});
+    return DecodeResult::Ok;
+}
+
+// Indexed by ServerCommand
+constexpr OpcodeEntry OPCODE_TABLE[] = {
+    {SetIdLayout::SIZE, decodeSetId},
+    {2, decodeWorldUpdate},  // Opcode + player count; the rest is validated while decoding
+    {CHUNK_MESSAGE_SIZE, decodeChunkLoad},
+    {TeleportLayout::SIZE, decodeTeleport},
+    {SetRankLayout::SIZE, decodeSetRank},
+    {CaptchaLayout::SIZE, decodeCaptcha},
+    {SetPQuotaLayout::SIZE, decodeSetPQuota},
+    {ChunkProtectedLayout::SIZE, decodeChunkProtected},
+    {MaxCountLayout::SIZE, decodeMaxCount},
+    {DonationUntilLayout::SIZE, decodeDonationUntil},
+};
+
+static_assert(sizeof(OPCODE_TABLE) / sizeof(OPCODE_TABLE[0]) == static_cast<size_t>(ServerCommand::Count),
+    "OPCODE_TABLE must have one entry per ServerCommand");
+
+} // namespace
+
+const char* toString(DecodeResult result) {
+    switch (result) {
+        case DecodeResult::Ok: return "ok";
+        case DecodeResult::Empty: return "empty message";
+        case DecodeResult::UnknownOpcode: return "unknown opcode";
+        case DecodeResult::Truncated: return "truncated message";
+        case DecodeResult::Malformed: return "malformed message";
+    }
+    return "unknown";
+}
+
+DecodeResult decode(const uint8_t* data, size_t length, MessageHandler& handler) {
+    if (length == 0) return DecodeResult::Empty;
+
+    uint8_t opcode = data[0];
+    if (opcode >= static_cast<uint8_t>(ServerCommand::Count)) return DecodeResult::UnknownOpcode;
+
+    const OpcodeEntry& entry = OPCODE_TABLE[opcode];
+    if (length < entry.minLength) return DecodeResult::Truncated;
+
+    return entry.decode(data, length, handler);
+}
+
+} // namespace protocol
+} // namespace owop
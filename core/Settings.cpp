@@ -12,6 +12,10 @@ void Settings::save() {
         j["serverDomain"] = serverDomain;
         j["worldName"] = worldName;
         j["requireCaptcha"] = requireCaptcha;
+        j["maxChunksInFlight"] = maxChunksInFlight;
+        j["compressTraffic"] = compressTraffic;
+        j["uploadBudgetKiB"] = uploadBudgetKiB;
+        j["chunkMemoryMiB"] = chunkMemoryMiB;
 
         std::filesystem::path settingsPath = "settings.json";
         std::ofstream file(settingsPath);
@@ -42,6 +46,10 @@ void Settings::load() {
             if (j.contains("serverDomain")) serverDomain = j["serverDomain"].get<std::string>();
             if (j.contains("worldName")) worldName = j["worldName"].get<std::string>();
             if (j.contains("requireCaptcha")) requireCaptcha = j["requireCaptcha"].get<bool>();
+            if (j.contains("maxChunksInFlight")) maxChunksInFlight = j["maxChunksInFlight"].get<int>();
+            if (j.contains("compressTraffic")) compressTraffic = j["compressTraffic"].get<bool>();
+            if (j.contains("uploadBudgetKiB")) uploadBudgetKiB = j["uploadBudgetKiB"].get<int>();
+            if (j.contains("chunkMemoryMiB")) chunkMemoryMiB = j["chunkMemoryMiB"].get<int>();
 
             Logger::info("Settings", "Settings loaded successfully");
         } else {
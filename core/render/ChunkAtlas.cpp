@@ -0,0 +1,58 @@
+#include <owop-client/render/ChunkAtlas.hpp>
+#include <owop-client/Constants.hpp>
+#include <owop-client/Logger.hpp>
+#include <algorithm>
+#include <string>
+
+namespace owop {
+
+ChunkAtlas::~ChunkAtlas() {
+    if (!pages.empty()) {
+        glDeleteTextures(static_cast<GLsizei>(pages.size()), pages.data());
+    }
+}
+
+ChunkSlot ChunkAtlas::allocate() {
+    if (freeSlots.empty()) {
+        addPage();
+    }
+
+    ChunkSlot slot = freeSlots.back();
+    freeSlots.pop_back();
+    return slot;
+}
+
+void ChunkAtlas::release(ChunkSlot slot) {
+    freeSlots.push_back(slot);
+}
+
+void ChunkAtlas::addPage() {
+    if (layersPerPage == 0) {
+        GLint maxLayers = 0;
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+        layersPerPage = std::min<size_t>(CHUNK_PAGE_LAYERS, std::max<GLint>(maxLayers, 1));
+    }
+
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB8, CHUNK_SIZE, CHUNK_SIZE, static_cast<GLsizei>(layersPerPage), 0,
+        GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+
+    auto page = static_cast<uint16_t>(pages.size());
+    pages.push_back(texture);
+
+    // Hand out layer 0 first
+    for (size_t layer = layersPerPage; layer-- > 0;) {
+        freeSlots.push_back(ChunkSlot{page, static_cast<uint16_t>(layer)});
+    }
+
+    Logger::info("ChunkRenderer", "Added atlas page " + std::to_string(page) + " (" +
+        std::to_string(layersPerPage) + " chunks)");
+}
+
+} // namespace owop
@@ -1,108 +1,461 @@
 #include <owop-client/render/ChunkRenderer.hpp>
 #include <owop-client/Logger.hpp>
+#include <algorithm>
 #include <cmath>
 
 namespace owop {
 
+namespace {
+
+// Tile corners are placed relative to a view origin split into a tile and an
+// offset inside it, so positions stay exact far from the world center where a
+// float world coordinate would not. A tile is a chunk at LOD level 0 and a
+// cluster of the level below above that.
+const char* CHUNK_VERTEX_SHADER = R"(
+#version 330 core
+layout(location = 0) in vec2 corner;
+layout(location = 1) in ivec3 instance;  // Tile x, tile y, atlas layer
+
+uniform ivec2 viewOriginTile;
+uniform vec2 viewOriginOffset;  // Pixels into viewOriginTile
+uniform vec2 viewScale;         // Pixels to clip space
+uniform float tileSize;         // Pixels per tile side at the drawn level
+
+out vec3 texCoord;
+
+void main() {
+    vec2 pixel = (vec2(instance.xy - viewOriginTile) + corner) * tileSize - viewOriginOffset;
+    gl_Position = vec4(pixel.x * viewScale.x - 1.0, 1.0 - pixel.y * viewScale.y, 0.0, 1.0);
+    texCoord = vec3(corner, float(instance.z));
+}
+)";
+
+const char* CHUNK_FRAGMENT_SHADER = R"(
+#version 330 core
+in vec3 texCoord;
+
+uniform sampler2DArray page;
+
+out vec4 fragColor;
+
+void main() {
+    fragColor = vec4(texture(page, texCoord).rgb, 1.0);
+}
+)";
+
+GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint compiled = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (!compiled) {
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        Logger::error("ChunkRenderer", std::string("Shader compile failed: ") + log);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+} // namespace
+
 ChunkRenderer::ChunkRenderer(GLFWwindow* window)
     : window(window)
 {
-    // Initialize shader program and other OpenGL resources here
+    // GL objects are created on the first render; the context doesn't exist yet
 }
 
 ChunkRenderer::~ChunkRenderer() {
-    // Clean up textures
-    for (auto& pair : chunks) {
-        if (pair.second.texture != 0) {
-            glDeleteTextures(1, &pair.second.texture);
-        }
+    if (program != 0) {
+        glDeleteProgram(program);
+        glDeleteBuffers(1, &quadBuffer);
+        glDeleteBuffers(1, &instanceBuffer);
+        glDeleteVertexArrays(1, &vertexArray);
     }
 }
 
-void ChunkRenderer::updateChunk(int x, int y, const std::vector<Color>& pixels) {
-    // Convert world coordinates to chunk coordinates
-    int chunkX = static_cast<int>(std::floor(static_cast<float>(x) / 16.0f));
-    int chunkY = static_cast<int>(std::floor(static_cast<float>(y) / 16.0f));
-    
-    uint64_t key = getChunkKey(chunkX, chunkY);
-    auto& chunk = chunks[key];
+bool ChunkRenderer::initGL() {
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, CHUNK_VERTEX_SHADER);
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, CHUNK_FRAGMENT_SHADER);
+    if (vertexShader == 0 || fragmentShader == 0) {
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        return false;
+    }
+
+    GLuint linked = glCreateProgram();
+    glAttachShader(linked, vertexShader);
+    glAttachShader(linked, fragmentShader);
+    glLinkProgram(linked);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(linked, GL_LINK_STATUS, &status);
+    if (!status) {
+        char log[1024];
+        glGetProgramInfoLog(linked, sizeof(log), nullptr, log);
+        Logger::error("ChunkRenderer", std::string("Shader link failed: ") + log);
+        glDeleteProgram(linked);
+        return false;
+    }
+    program = linked;
+    viewOriginTileLocation = glGetUniformLocation(program, "viewOriginTile");
+    tileSizeLocation = glGetUniformLocation(program, "tileSize");
+    viewOriginOffsetLocation = glGetUniformLocation(program, "viewOriginOffset");
+    viewScaleLocation = glGetUniformLocation(program, "viewScale");
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "page"), 0);
+    glUseProgram(0);
+
+    // One unit quad shared by every chunk, drawn as a triangle strip
+    static const float QUAD[] = {0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f};
+
+    glGenVertexArrays(1, &vertexArray);
+    glBindVertexArray(vertexArray);
+
+    glGenBuffers(1, &quadBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, quadBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(QUAD), QUAD, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+
+    // The instance attribute pointer is set per page in render()
+    glGenBuffers(1, &instanceBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return true;
+}
+
+void ChunkRenderer::updateChunk(int chunkX, int chunkY, ChunkPixels& pixels) {
+    auto inserted = chunks.try_emplace(getChunkKey(chunkX, chunkY));
+    auto& chunk = inserted.first->second;
+    if (inserted.second) {
+        indexTile(0, chunkX, chunkY, &chunk);
+        countLodSources(chunkX, chunkY, 1);
+    }
     
-    // Update chunk data
-    chunk.pixels = pixels;
-    chunk.dirty = true;
+    // The network already copied the pixels out of the message; take its buffer as is
+    chunk.pixels.swap(pixels);
+    chunk.dirty.addAll();
+    markLodStale(chunk, chunkX, chunkY);
+}
+
+void ChunkRenderer::indexTile(int level, int tileX, int tileY, Chunk* tile) {
+    int clusterX = floorDiv(tileX, CLUSTER_CHUNK_AMOUNT);
+    int clusterY = floorDiv(tileY, CLUSTER_CHUNK_AMOUNT);
+    int index = (tileY - clusterY * CLUSTER_CHUNK_AMOUNT) * CLUSTER_CHUNK_AMOUNT +
+        (tileX - clusterX * CLUSTER_CHUNK_AMOUNT);
+    if (tile) {
+        clusters[level][getChunkKey(clusterX, clusterY)].chunks[index] = tile;
+        return;
+    }
 
-    Logger::info("ChunkRenderer", "Updated chunk at (" + std::to_string(chunkX) + ", " + 
-        std::to_string(chunkY) + ") with " + std::to_string(pixels.size()) + " pixels");
+    auto cluster = clusters[level].find(getChunkKey(clusterX, clusterY));
+    if (cluster == clusters[level].end()) return;
+    cluster->second.chunks[index] = nullptr;
+    if (std::all_of(cluster->second.chunks.begin(), cluster->second.chunks.end(),
+            [](const Chunk* entry) { return entry == nullptr; })) {
+        clusters[level].erase(cluster);
+    }
 }
 
-void ChunkRenderer::updateChunkTexture(Chunk& chunk) {
-    if (!chunk.dirty) return;
+void ChunkRenderer::markLodStale(Chunk& chunk, int chunkX, int chunkY) {
+    if (chunk.lodStale) return;
+    chunk.lodStale = true;
+    lodStaleChunks.push_back(getChunkKey(chunkX, chunkY));
+}
 
-    // Create texture if it doesn't exist
-    if (chunk.texture == 0) {
-        glGenTextures(1, &chunk.texture);
-        glBindTexture(GL_TEXTURE_2D, chunk.texture);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+void ChunkRenderer::updateLod() {
+    // Hand the chunks changed since the last frame to the builder, one copy each
+    for (uint64_t key : lodStaleChunks) {
+        auto it = chunks.find(key);
+        if (it == chunks.end()) continue;
+        it->second.lodStale = false;
+        lodBuilder.submit(static_cast<int32_t>(key >> 32), static_cast<int32_t>(key & 0xFFFFFFFF), *it->second.pixels);
     }
+    lodStaleChunks.clear();
 
-    // Update texture data
-    glBindTexture(GL_TEXTURE_2D, chunk.texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 16, 16, 0, GL_RGB, GL_UNSIGNED_BYTE, chunk.pixels.data());
-    
-    chunk.dirty = false;
+    // Pick up what it has rebuilt; the tiles are uploaded like chunks when in view
+    lodBuilder.takeResults(lodResults);
+    for (const auto& tile : lodResults) {
+        // Built before its last chunk was evicted
+        uint64_t key = getChunkKey(tile.x, tile.y);
+        if (lodSources[tile.level].count(key) == 0) continue;
+
+        auto inserted = lodTiles[tile.level].try_emplace(key);
+        if (inserted.second) {
+            inserted.first->second.pixels = std::make_unique<ChunkPixelBuffer>();
+            indexTile(tile.level, tile.x, tile.y, &inserted.first->second);
+            lodTileCount++;
+        }
+        *inserted.first->second.pixels = tile.pixels;
+        inserted.first->second.dirty.addAll();
+    }
+}
+
+void ChunkRenderer::countLodSources(int chunkX, int chunkY, int delta) {
+    int tileX = chunkX;
+    int tileY = chunkY;
+    for (int level = 1; level < LOD_LEVELS; level++) {
+        tileX = floorDiv(tileX, CLUSTER_CHUNK_AMOUNT);
+        tileY = floorDiv(tileY, CLUSTER_CHUNK_AMOUNT);
+        uint64_t key = getChunkKey(tileX, tileY);
+        if (delta > 0) {
+            lodSources[level][key]++;
+            continue;
+        }
+
+        auto sources = lodSources[level].find(key);
+        if (--sources->second > 0) continue;
+        lodSources[level].erase(sources);
+
+        // Nothing under the tile is loaded any more; it goes with its last chunk
+        auto tile = lodTiles[level].find(key);
+        if (tile != lodTiles[level].end()) {
+            if (tile->second.hasSlot) {
+                atlas.release(tile->second.slot);
+            }
+            lodTiles[level].erase(tile);
+            indexTile(level, tileX, tileY, nullptr);
+            lodTileCount--;
+            stats.lodTilesEvicted++;
+        }
+        lodBuilder.drop(level, tileX, tileY);
+    }
+}
+
+void ChunkRenderer::applyPixelBatch(const PixelBatch& batch) {
+    // Drop updates for chunks that aren't loaded
+    auto it = chunks.find(getChunkKey(batch.chunkX, batch.chunkY));
+    if (it == chunks.end()) return;
+
+    auto& chunk = it->second;
+    for (const auto& entry : batch.pixels) {
+        (*chunk.pixels)[entry.index] = entry.color;
+        chunk.dirty.add(entry.index % CHUNK_SIZE, entry.index / CHUNK_SIZE);
+    }
+    markLodStale(chunk, batch.chunkX, batch.chunkY);
+    // Only the rectangle around the changed pixels is uploaded, once per frame
+    // no matter how many batches touched it
+}
+
+bool ChunkRenderer::updateChunkTexture(Chunk& chunk) {
+    if (chunk.dirty.empty()) return true;
+
+    // Over budget: draw what the texture has, or nothing before the first upload
+    if (!uploader.hasRoom(chunk.dirty.byteCount())) {
+        stats.uploadsDeferred++;
+        return chunk.hasSlot;
+    }
+
+    if (!chunk.hasSlot) {
+        chunk.slot = atlas.allocate();
+        chunk.hasSlot = true;
+    }
+    if (uploader.stage(chunk.slot, chunk.pixels->data(), chunk.dirty)) {
+        chunk.dirty.clear();
+    }
+    return true;
+}
+
+void ChunkRenderer::evictChunks(int centerChunkX, int centerChunkY) {
+    // Pixels here, the texture layer and the hash map node; an LOD tile also
+    // has the builder's copy of its pixels
+    constexpr size_t chunkCost = sizeof(Chunk) + sizeof(ChunkPixelBuffer) + CHUNK_PIXEL_BYTES + 4 * sizeof(void*);
+    constexpr size_t lodTileCost = chunkCost + sizeof(TilePixels) + 4 * sizeof(void*);
+    size_t budget = std::max(memoryBudget, static_cast<size_t>(CHUNK_MEMORY_MIN_MIB) * 1024 * 1024);
+    stats.memoryBytes = chunks.size() * chunkCost + lodTileCount * lodTileCost;
+    stats.memoryBudget = budget;
+    if (stats.memoryBytes <= budget) return;
+
+    // Keep the nearest chunks and go an eighth below the budget, so this runs
+    // once per burst of arrivals rather than every frame. Tiles go with their
+    // last chunk, so the chunks keep their share of the memory.
+    size_t target = budget - budget / 8;
+    size_t keep = static_cast<size_t>(static_cast<double>(chunks.size()) * target / stats.memoryBytes);
+    evictionOrder.clear();
+    for (const auto& pair : chunks) {
+        int64_t dx = static_cast<int32_t>(pair.first >> 32) - static_cast<int64_t>(centerChunkX);
+        int64_t dy = static_cast<int32_t>(pair.first & 0xFFFFFFFF) - static_cast<int64_t>(centerChunkY);
+        evictionOrder.emplace_back(dx * dx + dy * dy, pair.first);
+    }
+    std::nth_element(evictionOrder.begin(), evictionOrder.begin() + keep, evictionOrder.end());
+
+    evicted.clear();
+    for (auto it = evictionOrder.begin() + keep; it != evictionOrder.end(); ++it) {
+        uint64_t key = it->second;
+        int chunkX = static_cast<int32_t>(key >> 32);
+        int chunkY = static_cast<int32_t>(key & 0xFFFFFFFF);
+
+        auto chunk = chunks.find(key);
+        if (chunk->second.hasSlot) {
+            atlas.release(chunk->second.slot);  // Back to the pool for the next chunk
+        }
+
+        indexTile(0, chunkX, chunkY, nullptr);
+        chunks.erase(chunk);
+        countLodSources(chunkX, chunkY, -1);
+        evicted.emplace_back(chunkX, chunkY);
+    }
+    stats.chunksEvicted += evicted.size();
+    stats.memoryBytes = chunks.size() * chunkCost + lodTileCount * lodTileCost;
+    Logger::info("ChunkRenderer", "Evicted " + std::to_string(evicted.size()) + " far chunks");
+
+    // LOD tiles with other chunks still loaded keep showing them when zoomed out
+    if (chunkEvictedCallback) {
+        chunkEvictedCallback(evicted);
+    }
+}
+
+void ChunkRenderer::addInstance(Chunk& tile, int32_t tileX, int32_t tileY) {
+    if (!updateChunkTexture(tile)) return;
+
+    const ChunkSlot& slot = tile.slot;
+    if (pageInstances.size() <= slot.page) {
+        pageInstances.resize(slot.page + 1);
+    }
+    pageInstances[slot.page].push_back(Instance{tileX, tileY, slot.layer});
+}
+
+void ChunkRenderer::addVisibleTiles(int level, int minTileX, int minTileY, int maxTileX, int maxTileY) {
+    const auto& levelClusters = clusters[level];
+    for (int clusterY = floorDiv(minTileY, CLUSTER_CHUNK_AMOUNT);
+         clusterY <= floorDiv(maxTileY, CLUSTER_CHUNK_AMOUNT); clusterY++) {
+        for (int clusterX = floorDiv(minTileX, CLUSTER_CHUNK_AMOUNT);
+             clusterX <= floorDiv(maxTileX, CLUSTER_CHUNK_AMOUNT); clusterX++) {
+            auto it = levelClusters.find(getChunkKey(clusterX, clusterY));
+            if (it == levelClusters.end()) continue;
+
+            int baseX = clusterX * CLUSTER_CHUNK_AMOUNT;
+            int baseY = clusterY * CLUSTER_CHUNK_AMOUNT;
+            for (int tileY = std::max(minTileY, baseY); tileY <= std::min(maxTileY, baseY + CLUSTER_CHUNK_AMOUNT - 1); tileY++) {
+                for (int tileX = std::max(minTileX, baseX); tileX <= std::min(maxTileX, baseX + CLUSTER_CHUNK_AMOUNT - 1); tileX++) {
+                    Chunk* tile = it->second.chunks[(tileY - baseY) * CLUSTER_CHUNK_AMOUNT + (tileX - baseX)];
+                    if (tile) {
+                        addInstance(*tile, tileX, tileY);
+                    }
+                }
+            }
+        }
+    }
 }
 
 void ChunkRenderer::render(const Camera& camera, int windowWidth, int windowHeight) {
     glClear(GL_COLOR_BUFFER_BIT);
-    
-    // Set up orthographic projection
+
+    stats.drawCalls = 0;
+    stats.chunksDrawn = 0;
+    stats.uploadsDeferred = 0;
+    if (program == 0 && !initGL()) return;
+    updateLod();
+    evictChunks(floorDiv(static_cast<int>(std::floor(camera.getX())), CHUNK_SIZE),
+        floorDiv(static_cast<int>(std::floor(camera.getY())), CHUNK_SIZE));
+
+    // Visible area in world pixels
     float zoom = camera.getZoom();
     float left = camera.getX() - (windowWidth / 2.0f) / zoom;
     float right = camera.getX() + (windowWidth / 2.0f) / zoom;
     float bottom = camera.getY() + (windowHeight / 2.0f) / zoom;
     float top = camera.getY() - (windowHeight / 2.0f) / zoom;
 
-    // Enable texturing and blending
-    glEnable(GL_TEXTURE_2D);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    // Render each chunk
-    for (auto& pair : chunks) {
-        // Update texture if needed
-        updateChunkTexture(pair.second);
-
-        // Calculate chunk position
-        int chunkX = static_cast<int>(pair.first >> 32);
-        int chunkY = static_cast<int>(pair.first & 0xFFFFFFFF);
-        
-        float worldX = chunkX * 16.0f;
-        float worldY = chunkY * 16.0f;
-
-        // Skip chunks outside view
-        if (worldX + 16 < left || worldX > right || 
-            worldY + 16 < top || worldY > bottom) {
-            continue;
-        }
+    // Coarsest level that still has at least one texel per screen pixel, so
+    // the view never gets blockier than the screen. A tile can then be as
+    // small as 2x2 screen pixels; the level's clusters keep the lookups down
+    // to one per 16x16 screen pixels at worst.
+    int level = 0;
+    int tileSize = CHUNK_SIZE;
+    float texelOnScreen = zoom;  // Screen pixels per texel at the current level
+    while (level + 1 < LOD_LEVELS && texelOnScreen * CLUSTER_CHUNK_AMOUNT <= 1.0f) {
+        level++;
+        tileSize *= CLUSTER_CHUNK_AMOUNT;
+        texelOnScreen *= CLUSTER_CHUNK_AMOUNT;
+    }
+    stats.lodLevel = level;
 
-        // Bind texture
-        glBindTexture(GL_TEXTURE_2D, pair.second.texture);
+    // Tiles under the view, inclusive
+    int minTileX = floorDiv(static_cast<int>(std::floor(left)), tileSize);
+    int maxTileX = floorDiv(static_cast<int>(std::floor(right)), tileSize);
+    int minTileY = floorDiv(static_cast<int>(std::floor(top)), tileSize);
+    int maxTileY = floorDiv(static_cast<int>(std::floor(bottom)), tileSize);
 
-        // Draw textured quad
-        glBegin(GL_QUADS);
-        glTexCoord2f(0.0f, 0.0f); glVertex2f(worldX, worldY);
-        glTexCoord2f(1.0f, 0.0f); glVertex2f(worldX + 16, worldY);
-        glTexCoord2f(1.0f, 1.0f); glVertex2f(worldX + 16, worldY + 16);
-        glTexCoord2f(0.0f, 1.0f); glVertex2f(worldX, worldY + 16);
-        glEnd();
+    // Bucket visible tiles by atlas page. Only these get their textures
+    // updated; tiles changed off screen stay dirty until they come into view.
+    for (auto& instances : pageInstances) {
+        instances.clear();
     }
+    uploader.beginFrame(uploadBudget);
+    addVisibleTiles(level, minTileX, minTileY, maxTileX, maxTileY);
+
+    uploader.endFrame(atlas);
+    stats.textureUploads = uploader.stagedCount();
+    stats.uploadBytes = uploader.stagedBytes();
 
-    // Cleanup state
+    // All pages go up in one buffer; each draw points the instance attribute at its part
+    instanceData.clear();
+    for (const auto& instances : pageInstances) {
+        instanceData.insert(instanceData.end(), instances.begin(), instances.end());
+    }
+
+    stats.chunksLoaded = chunks.size();
+    stats.lodTiles = lodTileCount;
+    stats.lodPending = lodBuilder.pendingCount();
+    stats.pages = atlas.pageCount();
+    stats.slotsUsed = atlas.usedSlots();
+    stats.slotsTotal = atlas.capacity();
+    if (instanceData.empty()) return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, instanceData.size() * sizeof(Instance), instanceData.data(), GL_STREAM_DRAW);
+
+    // Chunks are opaque
     glDisable(GL_BLEND);
-    glDisable(GL_TEXTURE_2D);
+    glUseProgram(program);
+    glUniform2i(viewOriginTileLocation, minTileX, minTileY);
+    glUniform2f(viewOriginOffsetLocation, left - static_cast<float>(minTileX) * tileSize,
+        top - static_cast<float>(minTileY) * tileSize);
+    glUniform1f(tileSizeLocation, static_cast<float>(tileSize));
+    glUniform2f(viewScaleLocation, 2.0f * zoom / windowWidth, 2.0f * zoom / windowHeight);
+    glBindVertexArray(vertexArray);
+    glActiveTexture(GL_TEXTURE0);
+
+    size_t first = 0;
+    for (size_t page = 0; page < pageInstances.size(); page++) {
+        size_t count = pageInstances[page].size();
+        if (count == 0) continue;
+
+        glVertexAttribIPointer(1, 3, GL_INT, sizeof(Instance),
+            reinterpret_cast<const void*>(first * sizeof(Instance)));
+        glBindTexture(GL_TEXTURE_2D_ARRAY, atlas.pageTexture(page));
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(count));
+        stats.drawCalls++;
+        stats.chunksDrawn += count;
+        first += count;
+    }
+
+    // Leave fixed-function state for the player and UI passes
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glUseProgram(0);
+}
+
+bool ChunkRenderer::getPixel(int x, int y, Color& color) const {
+    int chunkX = floorDiv(x, CHUNK_SIZE);
+    int chunkY = floorDiv(y, CHUNK_SIZE);
+
+    auto it = chunks.find(getChunkKey(chunkX, chunkY));
+    if (it == chunks.end()) return false;
+
+    color = (*it->second.pixels)[(y - chunkY * CHUNK_SIZE) * CHUNK_SIZE + (x - chunkX * CHUNK_SIZE)];
+    return true;
 }
 
 void ChunkRenderer::setPixel(int x, int y, const Color& color) {
@@ -110,8 +463,10 @@ void ChunkRenderer::setPixel(int x, int y, const Color& color) {
     int chunkX = static_cast<int>(std::floor(static_cast<float>(x) / 16.0f));
     int chunkY = static_cast<int>(std::floor(static_cast<float>(y) / 16.0f));
     
-    uint64_t key = getChunkKey(chunkX, chunkY);
-    auto& chunk = chunks[key];
+    // Ignore pixels in chunks that haven't been loaded yet
+    auto it = chunks.find(getChunkKey(chunkX, chunkY));
+    if (it == chunks.end()) return;
+    auto& chunk = it->second;
 
     // Calculate pixel position within chunk
     int localX = x - (chunkX * 16);
@@ -119,9 +474,10 @@ void ChunkRenderer::setPixel(int x, int y, const Color& color) {
     int pixelIndex = (localY * 16 + localX);
 
     // Update pixel if within bounds
-    if (pixelIndex >= 0 && pixelIndex < 256 && chunk.pixels.size() == 256) {
-        chunk.pixels[pixelIndex] = color;
-        chunk.dirty = true;
+    if (pixelIndex >= 0 && pixelIndex < static_cast<int>(CHUNK_PIXEL_COUNT)) {
+        (*chunk.pixels)[pixelIndex] = color;
+        chunk.dirty.add(localX, localY);
+        markLodStale(chunk, chunkX, chunkY);
     }
 }
 
@@ -0,0 +1,90 @@
+#include <owop-client/render/ChunkUploader.hpp>
+#include <owop-client/Logger.hpp>
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace owop {
+
+ChunkUploader::~ChunkUploader() {
+    if (buffers[0] != 0) {
+        glDeleteBuffers(static_cast<GLsizei>(CHUNK_UPLOAD_RING_SIZE), buffers);
+    }
+}
+
+void ChunkUploader::beginFrame(size_t budgetBytes) {
+    budget = std::max(budgetBytes, CHUNK_PIXEL_BYTES);
+    used = 0;
+    uploads.clear();
+}
+
+bool ChunkUploader::mapNextBuffer() {
+    if (buffers[0] == 0) {
+        glGenBuffers(static_cast<GLsizei>(CHUNK_UPLOAD_RING_SIZE), buffers);
+    }
+
+    current = (current + 1) % CHUNK_UPLOAD_RING_SIZE;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers[current]);
+    if (bufferSizes[current] != budget) {
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(budget), nullptr, GL_STREAM_DRAW);
+        bufferSizes[current] = budget;
+    }
+
+    // Invalidating lets the driver hand out fresh memory instead of waiting on the GPU
+    mapped = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(budget),
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+
+    // Unbound while mapped, so texture allocations in between don't read from it
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (!mapped) {
+        Logger::error("ChunkRenderer", "Failed to map texture staging buffer");
+        return false;
+    }
+    return true;
+}
+
+bool ChunkUploader::stage(ChunkSlot slot, const Color* pixels, const DirtyRect& rect) {
+    size_t bytes = rect.byteCount();
+    if (bytes == 0 || !hasRoom(bytes) || bytes > budget) return false;
+    if (!mapped && !mapNextBuffer()) return false;
+
+    // Pack the rectangle's rows back to back
+    size_t rowBytes = rect.width() * sizeof(Color);
+    uint8_t* out = mapped + used;
+    for (size_t y = rect.minY; y <= rect.maxY; y++) {
+        std::memcpy(out, pixels + y * CHUNK_SIZE + rect.minX, rowBytes);
+        out += rowBytes;
+    }
+
+    uploads.push_back(Upload{slot, rect, used});
+    used += bytes;
+    return true;
+}
+
+void ChunkUploader::endFrame(const ChunkAtlas& atlas) {
+    if (!mapped) return;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers[current]);
+    mapped = nullptr;
+    if (!glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER)) {
+        // The driver lost the contents (e.g. a display mode change); those chunks
+        // keep their old pixels until they change again
+        Logger::warning("ChunkRenderer", "Texture staging buffer was lost; skipped " +
+            std::to_string(uploads.size()) + " upload(s)");
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return;
+    }
+
+    // Rows of a narrow rectangle aren't 4-byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (const auto& upload : uploads) {
+        glBindTexture(GL_TEXTURE_2D_ARRAY, atlas.pageTexture(upload.slot.page));
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, upload.rect.minX, upload.rect.minY, upload.slot.layer,
+            static_cast<GLsizei>(upload.rect.width()), static_cast<GLsizei>(upload.rect.height()), 1,
+            GL_RGB, GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(upload.offset));
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+} // namespace owop
@@ -0,0 +1,179 @@
+#include <owop-client/render/LodBuilder.hpp>
+#include <owop-client/Logger.hpp>
+#include <string>
+
+namespace owop {
+
+namespace {
+
+// Texels a child tile takes up in its parent, along each side
+constexpr int LOD_BLOCK = CHUNK_SIZE / CLUSTER_CHUNK_AMOUNT;
+static_assert(LOD_BLOCK * CLUSTER_CHUNK_AMOUNT == CHUNK_SIZE, "A cluster must shrink evenly into one tile");
+
+// Source texels averaged into one parent texel, along each side
+constexpr int LOD_SPAN = CHUNK_SIZE / LOD_BLOCK;
+
+// Parts of a tile with nothing loaded under them match the window's clear color
+const Color LOD_EMPTY_COLOR(51, 51, 51);
+
+uint64_t tileKey(int32_t x, int32_t y) {
+    return (static_cast<uint64_t>(x) << 32) | static_cast<uint32_t>(y);
+}
+
+// Average a child's 16x16 texels into its LOD_BLOCK x LOD_BLOCK block of the parent
+void reduceInto(const TilePixels& child, TilePixels& parent, int childX, int childY) {
+    for (int blockY = 0; blockY < LOD_BLOCK; blockY++) {
+        for (int blockX = 0; blockX < LOD_BLOCK; blockX++) {
+            uint32_t r = 0, g = 0, b = 0;
+            for (int y = blockY * LOD_SPAN; y < (blockY + 1) * LOD_SPAN; y++) {
+                for (int x = blockX * LOD_SPAN; x < (blockX + 1) * LOD_SPAN; x++) {
+                    const Color& color = child[y * CHUNK_SIZE + x];
+                    r += color.r;
+                    g += color.g;
+                    b += color.b;
+                }
+            }
+
+            constexpr uint32_t count = LOD_SPAN * LOD_SPAN;
+            int index = (childY * LOD_BLOCK + blockY) * CHUNK_SIZE + childX * LOD_BLOCK + blockX;
+            parent[index] = Color(static_cast<uint8_t>(r / count), static_cast<uint8_t>(g / count),
+                static_cast<uint8_t>(b / count));
+        }
+    }
+}
+
+} // namespace
+
+LodBuilder::LodBuilder() {
+    worker = std::thread([this]() { run(); });
+}
+
+LodBuilder::~LodBuilder() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void LodBuilder::submit(int32_t chunkX, int32_t chunkY, const TilePixels& pixels) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto inserted = jobIndex.emplace(tileKey(chunkX, chunkY), jobs.size());
+        if (inserted.second) {
+            jobs.push_back(Job{chunkX, chunkY, pixels});
+        } else {
+            jobs[inserted.first->second].pixels = pixels;
+        }
+    }
+    wake.notify_one();
+}
+
+void LodBuilder::drop(int level, int32_t tileX, int32_t tileY) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(Job{tileX, tileY, {}, level});
+        // A chunk resubmitted after this must not fold into a job ahead of it
+        jobIndex.clear();
+    }
+    wake.notify_one();
+}
+
+void LodBuilder::takeResults(std::vector<LodTile>& out) {
+    out.clear();
+    std::lock_guard<std::mutex> lock(mutex);
+    out.swap(results);
+}
+
+size_t LodBuilder::pendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return jobs.size();
+}
+
+void LodBuilder::run() {
+    std::vector<Job> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (stopping) return;
+
+            // Take everything queued; chunks resubmitted from here on start a new batch
+            batch.swap(jobs);
+            jobIndex.clear();
+        }
+
+        try {
+            // Build the chunks queued ahead of each drop before forgetting the tile
+            auto first = batch.begin();
+            for (auto it = batch.begin(); it != batch.end(); ++it) {
+                if (it->dropLevel == 0) continue;
+                build(first, it);
+                levels[it->dropLevel].erase(tileKey(it->chunkX, it->chunkY));
+                first = it + 1;
+            }
+            build(first, batch.end());
+        } catch (const std::exception& e) {
+            Logger::error("LodBuilder", "Error building LOD tiles: " + std::string(e.what()));
+        }
+        batch.clear();
+    }
+}
+
+void LodBuilder::build(std::vector<Job>::const_iterator first, std::vector<Job>::const_iterator last) {
+    if (first == last) return;
+
+    // Tiles touched at the level being built, as (x, y); each is folded into
+    // the level above once, however many of its children changed
+    std::unordered_map<uint64_t, std::pair<int32_t, int32_t>> changed;
+    std::unordered_map<uint64_t, std::pair<int32_t, int32_t>> parents;
+
+    for (auto job = first; job != last; ++job) {
+        int32_t tileX = floorDiv(job->chunkX, CLUSTER_CHUNK_AMOUNT);
+        int32_t tileY = floorDiv(job->chunkY, CLUSTER_CHUNK_AMOUNT);
+        uint64_t key = tileKey(tileX, tileY);
+
+        auto inserted = levels[1].try_emplace(key);
+        if (inserted.second) {
+            inserted.first->second.fill(LOD_EMPTY_COLOR);
+        }
+        reduceInto(job->pixels, inserted.first->second,
+            job->chunkX - tileX * CLUSTER_CHUNK_AMOUNT, job->chunkY - tileY * CLUSTER_CHUNK_AMOUNT);
+        changed.emplace(key, std::make_pair(tileX, tileY));
+    }
+
+    std::vector<LodTile> built;
+    for (int level = 1; level < LOD_LEVELS; level++) {
+        parents.clear();
+        for (const auto& entry : changed) {
+            int32_t tileX = entry.second.first;
+            int32_t tileY = entry.second.second;
+            const TilePixels& pixels = levels[level][entry.first];
+            built.push_back(LodTile{level, tileX, tileY, pixels});
+
+            if (level + 1 == LOD_LEVELS) continue;
+
+            int32_t parentX = floorDiv(tileX, CLUSTER_CHUNK_AMOUNT);
+            int32_t parentY = floorDiv(tileY, CLUSTER_CHUNK_AMOUNT);
+            uint64_t parentKey = tileKey(parentX, parentY);
+            auto inserted = levels[level + 1].try_emplace(parentKey);
+            if (inserted.second) {
+                inserted.first->second.fill(LOD_EMPTY_COLOR);
+            }
+            reduceInto(pixels, inserted.first->second,
+                tileX - parentX * CLUSTER_CHUNK_AMOUNT, tileY - parentY * CLUSTER_CHUNK_AMOUNT);
+            parents.emplace(parentKey, std::make_pair(parentX, parentY));
+        }
+        changed.swap(parents);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& tile : built) {
+        results.push_back(std::move(tile));
+    }
+}
+
+} // namespace owop
@@ -0,0 +1,83 @@
+#include <owop-client/render/PlayerRenderer.hpp>
+#include <owop-client/Constants.hpp>
+
+namespace owop {
+
+PlayerRenderer::PlayerRenderer() {
+}
+
+void PlayerRenderer::update(const PlayerSnapshotPtr& latest) {
+    if (!latest || (current && latest->sequence == current->sequence)) {
+        return;
+    }
+
+    previous = current;
+    current = latest;
+}
+
+float PlayerRenderer::getInterpolation(std::chrono::steady_clock::time_point now) const {
+    if (!previous) return 1.0f;
+
+    // Replay the movement of the last tick over the next tick, one tick behind the server
+    auto interval = std::chrono::duration<float>(current->receivedAt - previous->receivedAt).count();
+    if (interval <= 0.0f || interval * 1000.0f > PLAYER_INTERPOLATION_MAX_MS) {
+        return 1.0f;
+    }
+
+    float t = std::chrono::duration<float>(now - current->receivedAt).count() / interval;
+    if (t < 0.0f) return 0.0f;
+    if (t > 1.0f) return 1.0f;
+    return t;
+}
+
+void PlayerRenderer::render(const Camera& camera, int windowWidth, int windowHeight) {
+    if (!current || current->players.empty()) return;
+
+    float zoom = camera.getZoom();
+    float left = camera.getX() - (windowWidth / 2.0f) / zoom;
+    float right = camera.getX() + (windowWidth / 2.0f) / zoom;
+    float bottom = camera.getY() + (windowHeight / 2.0f) / zoom;
+    float top = camera.getY() - (windowHeight / 2.0f) / zoom;
+
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrtho(left, right, bottom, top, -1.0, 1.0);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+
+    float t = getInterpolation(std::chrono::steady_clock::now());
+    float size = PLAYER_CURSOR_SIZE / zoom;  // Constant size on screen
+
+    glBegin(GL_TRIANGLES);
+    for (const auto& pair : current->players) {
+        const Player& player = pair.second;
+        float x = static_cast<float>(player.x);
+        float y = static_cast<float>(player.y);
+
+        // Players that weren't in the previous snapshot appear at their current position
+        if (previous && t < 1.0f) {
+            auto it = previous->players.find(pair.first);
+            if (it != previous->players.end()) {
+                x = it->second.x + (x - it->second.x) * t;
+                y = it->second.y + (y - it->second.y) * t;
+            }
+        }
+
+        x /= PLAYER_POSITION_SCALE;
+        y /= PLAYER_POSITION_SCALE;
+
+        if (x + size < left || x > right || y + size < top || y > bottom) {
+            continue;
+        }
+
+        // Arrow-like marker with its tip on the cursor position
+        glColor3ub(player.r, player.g, player.b);
+        glVertex2f(x, y);
+        glVertex2f(x, y + size);
+        glVertex2f(x + size * 0.7f, y + size * 0.7f);
+    }
+    glEnd();
+    glColor3ub(255, 255, 255);
+}
+
+} // namespace owop
@@ -11,6 +11,8 @@ public:
     void move(float dx, float dy);
     void moveTo(float x, float y);
     void zoom(float delta);
+    // Lowest zoom allowed, at least MIN_ZOOM; a current zoom below it is raised
+    void setMinZoom(float zoom);
     
     float getX() const { return position.x; }
     float getY() const { return position.y; }
@@ -22,6 +24,7 @@ public:
 private:
     Vec2 position;
     float zoomLevel;
+    float minZoom;
 };
 
 } // namespace owop 
\ No newline at end of file
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 
 namespace owop {
 
@@ -8,9 +9,24 @@ constexpr int CLUSTER_CHUNK_AMOUNT = 8;
 
 // Camera constants
 constexpr float DEFAULT_ZOOM = 16.0f;
-constexpr float MIN_ZOOM = 1.0f;
+constexpr float MIN_ZOOM = 1.0f / 64.0f;  // One texel of the coarsest LOD level per screen pixel; the memory budget usually stops zooming out sooner
 constexpr float MAX_ZOOM = 32.0f;
 
+// Rendering constants
+constexpr size_t CHUNK_PAGE_LAYERS = 1024;  // Chunks per atlas page, one texture array layer each
+constexpr size_t CHUNK_UPLOAD_RING_SIZE = 3;   // Staging buffers cycled so a frame never writes one still in use
+constexpr int CHUNK_UPLOAD_BUDGET_KIB = 192;   // Default texture bytes uploaded per frame (256 full chunks)
+constexpr int LOD_LEVELS = 3;                  // Chunks, clusters of chunks, clusters of clusters
+constexpr int CHUNK_MEMORY_BUDGET_MIB = 256;   // Default memory for loaded chunks; the farthest are evicted beyond it
+constexpr int CHUNK_MEMORY_MIN_MIB = 16;       // Lowest budget allowed, enough for a full screen of chunks
+constexpr size_t CHUNK_MEMORY_VIEW_COST = 2048; // Bytes per chunk assumed when fitting the view to the budget, with headroom
+
+// Player cursor constants
+constexpr int PLAYER_POSITION_SCALE = 16;          // Cursor positions are sent in 1/16 pixel units
+constexpr int PLAYER_INTERPOLATION_MAX_MS = 500;   // Longer gaps between updates snap instead of crawling
+constexpr float PLAYER_CURSOR_SIZE = 12.0f;        // Cursor marker size in screen pixels
+constexpr int PLAYER_MOVE_INTERVAL_MS = 50;        // Our own cursor is sent at most once per server tick
+
 // Network constants
 constexpr const char* DEFAULT_SERVER = "wss://9060b3b6-0e87-42d2-93e3-2219d6422023-00-yo1d43p3n3x5.picard.replit.dev";
 constexpr const char* RECAPTCHA_SITE_KEY = "6LcgvScUAAAAAARUXtwrM8MP0A0N70z4DHNJh-KI";
@@ -21,6 +37,30 @@ constexpr const char* RECAPTCHA_SCRIPT = R"(
      data-callback="onCaptchaCompleted"></div>
 )";
 
+// Chunk pipeline constants
+constexpr int CHUNK_WINDOW_MIN = 1;           // Never go below one outstanding request
+constexpr int CHUNK_WINDOW_INITIAL = 4;       // Outstanding requests before any RTT sample
+constexpr int CHUNK_WINDOW_MAX = 64;          // Default upper bound, configurable in Settings
+constexpr float CHUNK_RTT_INFLATION = 2.0f;   // RTT above minRtt * this counts as congestion
+constexpr int CHUNK_VIEW_RADIUS_MAX = 1024;   // Max chunks requested in each direction; the camera's budget-based min zoom binds first
+constexpr int CHUNK_CANCEL_MARGIN = 2;        // Queued requests this far outside the view survive a pan
+constexpr int CHUNK_PREFETCH_MARGIN = 1;      // Ring of chunks around the view requested ahead of a pan
+constexpr int CHUNK_TIMEOUT_MS = 5000;        // Minimum time to wait for a chunk response
+constexpr int CHUNK_RETRY_BACKOFF_MS = 500;   // First retry delay, doubled for every further attempt
+constexpr int CHUNK_MAX_ATTEMPTS = 4;         // Give up on a chunk after this many requests
+constexpr int CHUNK_TIMER_INTERVAL_MS = 250;  // How often outstanding requests are checked
+constexpr int RECONNECT_BASE_MS = 500;        // First reconnect delay, doubled for every failed attempt
+constexpr int RECONNECT_MAX_MS = 30000;       // Cap on the reconnect delay
+constexpr size_t NETWORK_EVENT_QUEUE_SIZE = 512;  // Decoded chunk/pixel events buffered for the main thread (power of two)
+constexpr size_t SEND_HIGH_WATER_BYTES = 64 * 1024;  // Buffered bytes at which pixel sends wait; lower lanes wait sooner
+constexpr int SEND_RETRY_MS = 10;             // How soon a held-back sender looks again
+
+// Pixel placement constants
+constexpr size_t PIXEL_QUEUE_MAX = 4096;      // Distinct pixels waiting for quota; further writes are dropped
+constexpr float PIXEL_QUOTA_MARGIN = 0.95f;   // Refill slightly slower than the server so clock drift can't get us kicked
+constexpr int PIXEL_PACING_MIN_MS = 5;        // Shortest wait between pacing timer wakeups
+constexpr int PIXEL_CONFIRM_TIMEOUT_MS = 5000; // Roll back a local write the server hasn't echoed by then
+
 // Protocol constants
 constexpr const char* PROTOCOL_VERSION = "0"; // Protocol version
 constexpr const char* DEFAULT_WORLD = "main"; // Default world name
@@ -0,0 +1,78 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include "Wire.hpp"
+
+namespace owop {
+namespace protocol {
+
+// Compile-time description of a packed little-endian record: the field types in
+// wire order. Offsets and the total size are constants, so encode() and get<I>()
+// turn into a handful of fixed-offset stores/loads on a stack buffer.
+template<typename... Fields>
+struct Layout {
+    static_assert(sizeof...(Fields) > 0, "Layout needs at least one field");
+
+    static constexpr size_t SIZE = (sizeof(Fields) + ...);
+    static constexpr size_t FIELD_COUNT = sizeof...(Fields);
+
+    template<size_t I>
+    using FieldType = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    template<size_t I>
+    static constexpr size_t offset() {
+        constexpr size_t sizes[] = {sizeof(Fields)...};
+        size_t result = 0;
+        for (size_t i = 0; i < I; i++) {
+            result += sizes[i];
+        }
+        return result;
+    }
+
+    using Buffer = std::array<uint8_t, SIZE>;
+
+    static void encode(uint8_t* dst, Fields... values) {
+        encodeFields(dst, std::index_sequence_for<Fields...>(), values...);
+    }
+
+    template<size_t I>
+    static FieldType<I> get(const uint8_t* src) {
+        return wire::readLE<FieldType<I>>(src + offset<I>());
+    }
+
+private:
+    template<size_t... I>
+    static void encodeFields(uint8_t* dst, std::index_sequence<I...>, Fields... values) {
+        (wire::writeLE<Fields>(dst + offset<I>(), values), ...);
+    }
+};
+
+// A Layout that starts with a one-byte opcode. field<I>() skips the opcode.
+template<auto Opcode, typename... Fields>
+struct Message : Layout<uint8_t, Fields...> {
+    using Base = Layout<uint8_t, Fields...>;
+    using Buffer = typename Base::Buffer;
+
+    static constexpr uint8_t OPCODE = static_cast<uint8_t>(Opcode);
+
+    static Buffer make(Fields... values) {
+        Buffer buffer;
+        Base::encode(buffer.data(), OPCODE, values...);
+        return buffer;
+    }
+
+    static void encodeInto(Buffer& buffer, Fields... values) {
+        Base::encode(buffer.data(), OPCODE, values...);
+    }
+
+    template<size_t I>
+    static typename Base::template FieldType<I + 1> field(const uint8_t* msg) {
+        return Base::template get<I + 1>(msg);
+    }
+};
+
+} // namespace protocol
+} // namespace owop
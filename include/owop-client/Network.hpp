@@ -9,6 +9,7 @@
 #include "CaptchaServer.hpp"
 #include "Player.hpp"
 #include "Settings.hpp"
+#include "NetworkStats.hpp"
 
 namespace owop {
 
@@ -19,23 +20,51 @@ public:
     Network();
     ~Network();
 
+    // Both return immediately; the session moves through SessionState on the
+    // network thread (see getConnectionStats)
     void connect(const std::string& url, const std::string& worldName);
     void disconnect();
     void submitCaptcha(const std::string& token);
-    const std::unordered_map<uint32_t, Player>& getPlayers() const;
-    void requestChunksInView(int32_t centerX, int32_t centerY, float zoom);
+    // Immutable snapshot of the other players; never null. Main thread only; never locks.
+    PlayerSnapshotPtr getPlayers() const;
+    void requestChunksInView(int32_t centerX, int32_t centerY, float zoom, int viewportWidth, int viewportHeight);
+    // The renderer dropped these chunks; forget them so they are requested again
+    void forgetChunks(const std::vector<Vec2i>& chunks);
     bool isWaitingForCaptcha() const;
+    uint32_t getPlayerId() const;  // 0 until the server assigns one
+    ChunkPipelineStats getChunkPipelineStats() const;
 
-    void setChunkDataCallback(std::function<void(int, int, const std::vector<Color>&)> callback);
-    void setPixelUpdateCallback(std::function<void(int, int, const Color&)> callback);
+    // Queue a pixel for placement. Repeated writes to a queued pixel only send the
+    // last color; sends are paced to the server's pixel quota. False if dropped.
+    bool placePixel(int32_t x, int32_t y, const Color& color);
+    PixelWriteStats getPixelWriteStats() const;
+
+    // Report our cursor position in 1/16 pixel units; call every frame. A move
+    // is sent at most once per server tick and only when the cursor changed
+    // pixel, color or tool, behind all other traffic.
+    void moveCursor(int32_t x, int32_t y, const Color& color, uint8_t tool);
+
+    // The chunk callback may take the pixel buffer, swapping in one of its own;
+    // whatever is left in it afterwards is reused for a later chunk
+    void setChunkDataCallback(std::function<void(int, int, ChunkPixels&)> callback);
+    void setPixelBatchCallback(std::function<void(const PixelBatch&)> callback);
+    // The server moved us to this world pixel position
+    void setTeleportCallback(std::function<void(int32_t, int32_t)> callback);
+
+    // Runs the chunk, pixel and teleport callbacks on the calling thread for everything
+    // received since the last call. Call once per frame from the main loop.
+    void dispatchEvents();
+    EventQueueStats getEventQueueStats() const;
+    ConnectionStats getConnectionStats() const;
+    CompressionStats getCompressionStats() const;
+    SendStats getSendStats() const;
 
 private:
     void handleWorldData(const std::string& data);
     void handleChunkData(const std::string& data);
     void runNetworkLoop();
 
-    std::function<void(int, int, const std::vector<Color>&)> chunkDataCallback;
-    std::function<void(int, int, const Color&)> pixelUpdateCallback;
+    std::function<void(int, int, ChunkPixels&)> chunkDataCallback;
     std::thread networkThread;
     std::atomic<bool> running{false};
     std::unique_ptr<CaptchaServer> captchaServer;
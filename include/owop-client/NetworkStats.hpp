@@ -0,0 +1,135 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace owop {
+
+// Snapshot of the chunk request pipeline, safe to copy to the UI thread
+struct ChunkPipelineStats {
+    double chunksPerSecond = 0.0;
+    double smoothedRttMs = 0.0;
+    double minRttMs = 0.0;
+    size_t inFlight = 0;   // Requests sent but not yet answered
+    size_t window = 0;     // Current in-flight limit
+    size_t queued = 0;     // Requests waiting for a free slot
+    uint64_t received = 0;
+    uint64_t cancelled = 0; // Queued requests dropped after leaving the view
+    uint64_t timeouts = 0;  // Requests that missed their deadline
+    uint64_t retries = 0;   // Timed out requests sent again
+    uint64_t abandoned = 0; // Chunks given up on after CHUNK_MAX_ATTEMPTS
+};
+
+// Phases of a session, in the order they are passed through
+enum class SessionState : uint8_t {
+    Idle,          // Not connected and not trying to be
+    Connecting,    // TCP, TLS and websocket handshakes
+    Captcha,       // Socket open, waiting for the server to let us in
+    Joining,       // World join sent, waiting for setId
+    InWorld,       // Steady state: chunk pipeline, pixel and cursor writers
+    Reconnecting   // Waiting for the backoff timer before the next attempt
+};
+
+constexpr size_t SESSION_STATE_COUNT = 6;
+
+inline const char* toString(SessionState state) {
+    switch (state) {
+        case SessionState::Idle: return "Idle";
+        case SessionState::Connecting: return "Connecting";
+        case SessionState::Captcha: return "Captcha";
+        case SessionState::Joining: return "Joining";
+        case SessionState::InWorld: return "In world";
+        case SessionState::Reconnecting: return "Reconnecting";
+    }
+    return "Unknown";
+}
+
+// Connection and automatic reconnect state
+struct ConnectionStats {
+    SessionState state = SessionState::Idle;
+    double phaseMs[SESSION_STATE_COUNT] = {};  // How long the last pass through each state took
+    bool connected = false;     // Socket open (Captcha, Joining or InWorld)
+    bool reconnecting = false;  // Waiting for the backoff timer before the next attempt
+    int reconnectAttempt = 0;   // Attempts since the last successful world join
+    uint64_t reconnects = 0;    // Reconnect attempts made this run
+    bool tls = false;           // wss:// (true) or ws:// (false)
+    uint64_t tlsHandshakes = 0;
+    uint64_t tlsResumptions = 0; // Handshakes that resumed a previous TLS session
+};
+
+// Inbound binary messages and what permessage-deflate saved on them
+struct CompressionStats {
+    bool offered = false;         // Settings::compressTraffic at the last connect attempt
+    bool negotiated = false;      // The current connection uses permessage-deflate
+    uint64_t messages = 0;
+    uint64_t compressedMessages = 0;
+    uint64_t payloadBytes = 0;    // Message bytes after inflating
+    uint64_t wireBytes = 0;       // Message bytes as received, compressed ones at their compressed size
+    double inflateMs = 0.0;       // Time spent inflating
+};
+
+// Outgoing traffic is split into lanes, written in this order. Under backpressure
+// the lower lanes wait first, so a chunk sweep never delays a pixel placement.
+enum class SendLane : uint8_t {
+    Control,         // Captcha token, world join
+    Pixels,
+    VisibleChunks,   // Chunk requests inside the view
+    PrefetchChunks,  // Chunk requests in the margin around it
+    Moves            // Own cursor position; only the newest is kept
+};
+
+constexpr size_t SEND_LANE_COUNT = 5;
+
+inline const char* toString(SendLane lane) {
+    switch (lane) {
+        case SendLane::Control: return "Control";
+        case SendLane::Pixels: return "Pixels";
+        case SendLane::VisibleChunks: return "Visible chunks";
+        case SendLane::PrefetchChunks: return "Prefetch chunks";
+        case SendLane::Moves: return "Moves";
+    }
+    return "Unknown";
+}
+
+struct SendLaneStats {
+    size_t queuedFrames = 0;
+    size_t queuedBytes = 0;
+    size_t peakQueuedFrames = 0;
+    uint64_t sent = 0;
+    uint64_t replaced = 0;   // Frames superseded before they were written (moves)
+    double avgWaitMs = 0.0;  // Time from queueing to hand-off to the socket, smoothed
+    double maxWaitMs = 0.0;
+};
+
+// Outbound frames and socket backpressure
+struct SendStats {
+    size_t bufferedBytes = 0;     // Handed to the socket but not yet written
+    size_t peakBufferedBytes = 0;
+    size_t highWater = 0;         // Buffered bytes at which the pixel lane waits; lower lanes wait sooner
+    uint64_t flushes = 0;
+    uint64_t stalls = 0;          // Times a chunk or pixel producer was held back
+    uint64_t movesSent = 0;
+    uint64_t movesCoalesced = 0;  // Cursor positions folded into a later move by the per-tick limit
+    SendLaneStats lanes[SEND_LANE_COUNT];
+};
+
+// Handoff queue between the websocket thread and the main thread
+struct EventQueueStats {
+    size_t depth = 0;       // Events waiting for the next dispatchEvents()
+    size_t peakDepth = 0;
+    size_t capacity = 0;
+    uint64_t overflows = 0; // Events dropped because the queue was full
+    uint64_t dispatched = 0;
+};
+
+// Outbound pixel placement queue
+struct PixelWriteStats {
+    size_t pending = 0;     // Distinct pixels waiting for quota
+    uint64_t sent = 0;
+    uint64_t coalesced = 0; // Writes merged into an already pending pixel
+    uint64_t dropped = 0;   // Writes rejected (queue full, not connected) or discarded on disconnect
+    double tokens = 0.0;    // Pixels that can be sent right now
+    uint16_t quotaRate = 0; // Server quota: quotaRate pixels...
+    uint16_t quotaPer = 0;  // ...every quotaPer seconds; 0/0 until setPQuota arrives
+};
+
+} // namespace owop
@@ -0,0 +1,72 @@
+#pragma once
+#include "Types.hpp"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+namespace owop {
+
+// Latencies in power-of-two millisecond buckets: bucket i counts samples in
+// [2^i, 2^(i+1)) ms, bucket 0 also takes everything under a millisecond.
+struct LatencyHistogram {
+    static constexpr size_t BUCKET_COUNT = 16;  // Last bucket is open-ended (32 s and up)
+
+    std::array<uint64_t, BUCKET_COUNT> buckets{};
+    uint64_t count = 0;
+
+    void record(double ms);
+
+    // Upper edge of the bucket holding the given fraction (0..1) of samples
+    double percentile(double fraction) const;
+};
+
+// Pixel writes shown locally before the server confirmed them. Keyed by pixel
+// coordinate; each entry remembers the color underneath so the write can be
+// rolled back. A write is confirmed when our own pixel update comes back in a
+// worldUpdate, and rolled back if that doesn't happen in time.
+// Main thread only.
+class PendingPixelWrites {
+public:
+    using Clock = std::chrono::steady_clock;
+    using RollbackFn = std::function<void(int32_t x, int32_t y, const Color& color)>;
+
+    // Track a write that was just drawn locally over previous
+    void add(int32_t x, int32_t y, const Color& placed, const Color& previous, Clock::time_point now);
+
+    // A pixel update from the server. Returns true if a pending write should stay
+    // on top of it, in which case display is the color to draw.
+    bool onServerUpdate(int32_t x, int32_t y, const Color& color, bool fromUs, Clock::time_point now, Color& display);
+
+    // Roll back writes older than timeout. Time before busySince doesn't count,
+    // so writes still waiting in the outbound queue aren't expired early.
+    size_t expire(Clock::time_point now, Clock::time_point busySince, Clock::duration timeout, const RollbackFn& rollback);
+
+    void clear() { writes.clear(); }
+
+    size_t size() const { return writes.size(); }
+    bool empty() const { return writes.empty(); }
+    uint64_t confirmedCount() const { return confirmed; }
+    uint64_t rolledBackCount() const { return rolledBack; }
+    const LatencyHistogram& getLatency() const { return latency; }
+
+private:
+    struct Write {
+        Color placed;
+        Color previous;  // Latest server color under the write
+        Clock::time_point placedAt;
+    };
+
+    static uint64_t key(int32_t x, int32_t y) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+    }
+
+    std::unordered_map<uint64_t, Write> writes;
+    LatencyHistogram latency;
+    uint64_t confirmed = 0;
+    uint64_t rolledBack = 0;
+};
+
+} // namespace owop
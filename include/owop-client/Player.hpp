@@ -1,10 +1,13 @@
 #pragma once
+#include <chrono>
 #include <cstdint>
+#include <memory>
+#include <unordered_map>
 
 namespace owop {
 
 struct Player {
-    int32_t x;
+    int32_t x;  // Cursor position in 1/16 pixel units
     int32_t y;
     uint8_t r;
     uint8_t g;
@@ -12,4 +15,14 @@ struct Player {
     uint8_t tool;
 };
 
-} // namespace owop 
\ No newline at end of file
+// All other players as of one worldUpdate. Published by the network thread and
+// never modified afterwards, so readers can keep one as long as they like.
+struct PlayerSnapshot {
+    uint64_t sequence = 0;  // Increases by one with every published snapshot
+    std::chrono::steady_clock::time_point receivedAt;
+    std::unordered_map<uint32_t, Player> players;
+};
+
+using PlayerSnapshotPtr = std::shared_ptr<const PlayerSnapshot>;
+
+} // namespace owop
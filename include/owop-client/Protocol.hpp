@@ -3,31 +3,41 @@
 #include <string>
 #include <vector>
 #include "Types.hpp"
+#include "MessageLayout.hpp"
 
 namespace owop {
 namespace protocol {
 
-// Server -> Client commands
+// 1 byte opcode + 4 bytes x + 4 bytes y + 1 byte locked + 16x16x3 bytes of RGB
+constexpr size_t CHUNK_MESSAGE_SIZE = 778;
+
+// Server -> Client commands (first byte of every binary message)
 enum class ServerCommand : uint8_t {
     SetId = 0,
     WorldUpdate = 1,
     ChunkLoad = 2,
     Teleport = 3,
     SetRank = 4,
-    CaptchaRequest = 5,
-    SetWorldName = 6,
-    PlayerCount = 7,
-    Chat = 8,
-    DevChat = 9,
-    PlayersLeft = 10,
-    PlayersMoved = 11,
-    MaxCount = 12,
-    DonatorStatus = 13
+    Captcha = 5,
+    SetPQuota = 6,
+    ChunkProtected = 7,
+    MaxCount = 8,
+    DonationUntil = 9,
+    Count
+};
+
+// Captcha states sent with ServerCommand::Captcha
+enum class CaptchaState : uint8_t {
+    Waiting = 0,
+    Verifying = 1,
+    Verified = 2,
+    Ok = 3,
+    Invalid = 4
 };
 
 // Client -> Server commands
 enum class ClientCommand : uint8_t {
-    RequestChunk = 'c',     // 'c' - Request chunk at (x, y)
+    RequestChunk = 0x02,   // Request chunk at (x, y); mirrors the server's chunkLoad opcode
     Pixel = 'p',           // 'p' - Place pixel
     Move = 'm',            // 'm' - Move to (x, y)
     Chat = 'c',            // 'c' - Send chat message
@@ -46,7 +56,15 @@ struct PixelUpdate {
     int x;
     int y;
     Color color;
-    int32_t id;  // Player ID
+    uint32_t id;  // Player ID
+};
+
+struct PlayerUpdate {
+    uint32_t id;
+    int32_t x;
+    int32_t y;
+    Color color;
+    uint8_t tool;
 };
 
 struct PlayerMove {
@@ -55,33 +73,51 @@ struct PlayerMove {
     float y;
 };
 
-// Helper functions
-inline std::vector<uint8_t> makeChunkRequest(int x, int y) {
-    std::vector<uint8_t> msg;
-    msg.push_back(static_cast<uint8_t>(ClientCommand::RequestChunk));
-    // x and y are sent as 32-bit integers
-    msg.insert(msg.end(), reinterpret_cast<uint8_t*>(&x), reinterpret_cast<uint8_t*>(&x) + 4);
-    msg.insert(msg.end(), reinterpret_cast<uint8_t*>(&y), reinterpret_cast<uint8_t*>(&y) + 4);
-    return msg;
+// Wire layouts, shared by the encoders below and the decoder in ProtocolDecoder.cpp.
+// Server -> Client
+using SetIdLayout = Message<ServerCommand::SetId, uint32_t>;
+using ChunkLoadHeaderLayout = Message<ServerCommand::ChunkLoad, int32_t, int32_t, uint8_t>;  // x, y, locked; pixels follow
+using TeleportLayout = Message<ServerCommand::Teleport, int32_t, int32_t>;
+using SetRankLayout = Message<ServerCommand::SetRank, uint8_t>;
+using CaptchaLayout = Message<ServerCommand::Captcha, uint8_t>;
+using SetPQuotaLayout = Message<ServerCommand::SetPQuota, uint16_t, uint16_t>;  // rate, per
+using ChunkProtectedLayout = Message<ServerCommand::ChunkProtected, int32_t, int32_t, uint8_t>;
+using MaxCountLayout = Message<ServerCommand::MaxCount, uint16_t>;
+using DonationUntilLayout = Message<ServerCommand::DonationUntil, uint64_t, float>;
+
+// worldUpdate records
+using PlayerRecordLayout = Layout<uint32_t, int32_t, int32_t, uint8_t, uint8_t, uint8_t, uint8_t>;  // id, x, y, r, g, b, tool
+using PixelRecordLayout = Layout<uint32_t, int32_t, int32_t, uint8_t, uint8_t, uint8_t>;            // id, x, y, r, g, b
+using DisconnectRecordLayout = Layout<uint32_t>;
+
+// Client -> Server
+using ChunkRequestLayout = Message<ClientCommand::RequestChunk, int32_t, int32_t>;
+using PixelLayout = Message<ClientCommand::Pixel, int32_t, int32_t, uint8_t, uint8_t, uint8_t>;
+using MoveLayout = Message<ClientCommand::Move, int32_t, int32_t, uint8_t, uint8_t, uint8_t, uint8_t>;  // x, y, r, g, b, tool
+
+static_assert(ChunkLoadHeaderLayout::SIZE + CHUNK_PIXEL_BYTES == CHUNK_MESSAGE_SIZE, "chunkLoad size mismatch");
+
+// Helper functions. Fixed-size messages are encoded into stack buffers.
+inline ChunkRequestLayout::Buffer makeChunkRequest(int32_t x, int32_t y) {
+    return ChunkRequestLayout::make(x, y);
 }
 
-inline std::vector<uint8_t> makePixelUpdate(int x, int y, const Color& color) {
-    std::vector<uint8_t> msg;
-    msg.push_back(static_cast<uint8_t>(ClientCommand::Pixel));
-    msg.insert(msg.end(), reinterpret_cast<uint8_t*>(&x), reinterpret_cast<uint8_t*>(&x) + 4);
-    msg.insert(msg.end(), reinterpret_cast<uint8_t*>(&y), reinterpret_cast<uint8_t*>(&y) + 4);
-    msg.push_back(color.r);
-    msg.push_back(color.g);
-    msg.push_back(color.b);
-    return msg;
+inline PixelLayout::Buffer makePixelUpdate(int32_t x, int32_t y, const Color& color) {
+    return PixelLayout::make(x, y, color.r, color.g, color.b);
+}
+
+inline MoveLayout::Buffer makeMove(int32_t x, int32_t y, const Color& color, uint8_t tool) {
+    return MoveLayout::make(x, y, color.r, color.g, color.b, tool);
 }
 
+// Variable length, so this one still builds a vector
 inline std::vector<uint8_t> makeCaptchaResponse(const std::string& token) {
     std::vector<uint8_t> msg;
+    msg.reserve(1 + token.size());
     msg.push_back(static_cast<uint8_t>(ClientCommand::CaptchaResponse));
     msg.insert(msg.end(), token.begin(), token.end());
     return msg;
 }
 
 } // namespace protocol
-} // namespace owop 
\ No newline at end of file
+} // namespace owop
\ No newline at end of file
@@ -0,0 +1,153 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "Protocol.hpp"
+#include "Types.hpp"
+#include "Wire.hpp"
+
+namespace owop {
+namespace protocol {
+
+// Typed views of server messages. They point into the buffer passed to decode()
+// and are only valid for the duration of the handler call - nothing is copied
+// or allocated while decoding.
+
+// Fixed-size records inside a message, decoded lazily on access
+template<typename T, size_t RecordSize, T (*Decode)(const uint8_t*)>
+class RecordView {
+public:
+    static constexpr size_t RECORD_SIZE = RecordSize;
+
+    class Iterator {
+    public:
+        Iterator(const uint8_t* ptr) : ptr(ptr) {}
+        T operator*() const { return Decode(ptr); }
+        Iterator& operator++() { ptr += RecordSize; return *this; }
+        bool operator!=(const Iterator& other) const { return ptr != other.ptr; }
+
+    private:
+        const uint8_t* ptr;
+    };
+
+    RecordView() : data(nullptr), count(0) {}
+    RecordView(const uint8_t* data, size_t count) : data(data), count(count) {}
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    T operator[](size_t index) const { return Decode(data + index * RecordSize); }
+    Iterator begin() const { return Iterator(data); }
+    Iterator end() const { return Iterator(data + count * RecordSize); }
+
+private:
+    const uint8_t* data;
+    size_t count;
+};
+
+inline PlayerUpdate decodePlayerUpdate(const uint8_t* p) {
+    using L = PlayerRecordLayout;
+    return PlayerUpdate{
+        L::get<0>(p),
+        L::get<1>(p),
+        L::get<2>(p),
+        Color(L::get<3>(p), L::get<4>(p), L::get<5>(p)),
+        L::get<6>(p)
+    };
+}
+
+inline PixelUpdate decodePixelUpdate(const uint8_t* p) {
+    using L = PixelRecordLayout;
+    PixelUpdate update;
+    update.id = L::get<0>(p);
+    update.x = L::get<1>(p);
+    update.y = L::get<2>(p);
+    update.color = Color(L::get<3>(p), L::get<4>(p), L::get<5>(p));
+    return update;
+}
+
+inline uint32_t decodePlayerId(const uint8_t* p) {
+    return DisconnectRecordLayout::get<0>(p);
+}
+
+struct SetIdMessage {
+    uint32_t id;
+};
+
+struct WorldUpdateMessage {
+    RecordView<PlayerUpdate, PlayerRecordLayout::SIZE, decodePlayerUpdate> players;
+    RecordView<PixelUpdate, PixelRecordLayout::SIZE, decodePixelUpdate> pixels;
+    RecordView<uint32_t, DisconnectRecordLayout::SIZE, decodePlayerId> disconnects;
+};
+
+struct ChunkLoadMessage {
+    int32_t x;  // Chunk coordinates
+    int32_t y;
+    bool locked;
+    ChunkPixelsView pixels;
+};
+
+struct TeleportMessage {
+    int32_t x;
+    int32_t y;
+};
+
+struct SetRankMessage {
+    uint8_t rank;
+};
+
+struct CaptchaMessage {
+    CaptchaState state;
+};
+
+struct SetPQuotaMessage {
+    uint16_t rate;  // Pixels that may be placed...
+    uint16_t per;   // ...every this many seconds
+};
+
+struct ChunkProtectedMessage {
+    int32_t x;
+    int32_t y;
+    bool locked;
+};
+
+struct MaxCountMessage {
+    uint16_t maxPlayers;
+};
+
+struct DonationUntilMessage {
+    uint64_t untilMs;  // Unix time in milliseconds
+    float multiplier;
+};
+
+// Receives decoded messages; override the ones you care about
+class MessageHandler {
+public:
+    virtual ~MessageHandler() = default;
+
+    virtual void onSetId(const SetIdMessage&) {}
+    virtual void onWorldUpdate(const WorldUpdateMessage&) {}
+    virtual void onChunkLoad(const ChunkLoadMessage&) {}
+    virtual void onTeleport(const TeleportMessage&) {}
+    virtual void onSetRank(const SetRankMessage&) {}
+    virtual void onCaptcha(const CaptchaMessage&) {}
+    virtual void onSetPQuota(const SetPQuotaMessage&) {}
+    virtual void onChunkProtected(const ChunkProtectedMessage&) {}
+    virtual void onMaxCount(const MaxCountMessage&) {}
+    virtual void onDonationUntil(const DonationUntilMessage&) {}
+};
+
+enum class DecodeResult {
+    Ok,
+    Empty,          // Zero-length message
+    UnknownOpcode,
+    Truncated,      // Shorter than the opcode's fixed part
+    Malformed       // A length or count field points past the end of the message
+};
+
+const char* toString(DecodeResult result);
+
+// Decode one binary server message and dispatch it to the handler.
+// The handler is only called when the whole message is valid.
+DecodeResult decode(const uint8_t* data, size_t length, MessageHandler& handler);
+
+} // namespace protocol
+} // namespace owop
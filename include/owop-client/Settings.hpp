@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include "Constants.hpp"
 
 namespace owop {
 
@@ -15,6 +16,14 @@ public:
     std::string worldName = "main";
     bool requireCaptcha = true;
 
+    // Network tuning
+    int maxChunksInFlight = CHUNK_WINDOW_MAX;  // Upper bound for the adaptive chunk request window
+    bool compressTraffic = true;  // Offer permessage-deflate; applies from the next connect
+
+    // Rendering
+    int uploadBudgetKiB = CHUNK_UPLOAD_BUDGET_KIB;  // Chunk texture bytes uploaded per frame; the rest waits
+    int chunkMemoryMiB = CHUNK_MEMORY_BUDGET_MIB;   // Pixels and textures of loaded chunks; farthest evicted first
+
     // Save/Load settings
     void save();
     void load();
@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace owop {
+
+// Bounded lock-free ring for exactly one producer thread and one consumer thread.
+// Slots are allocated once up front and reused: the producer fills a slot in
+// place and the consumer reads it in place, so neither side allocates or blocks.
+template<typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscRing() : slots(Capacity) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer only. Calls fill(T&) on the next free slot; false if the ring is full.
+    template<typename Fill>
+    bool tryPush(Fill&& fill) {
+        size_t currentTail = tail.load(std::memory_order_relaxed);
+        if (currentTail - head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+
+        fill(slots[currentTail & (Capacity - 1)]);
+        tail.store(currentTail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Calls handler(T&) on every item that was queued when the
+    // call started and returns how many were handled.
+    template<typename Handler>
+    size_t drain(Handler&& handler) {
+        size_t currentHead = head.load(std::memory_order_relaxed);
+        size_t end = tail.load(std::memory_order_acquire);
+
+        for (size_t i = currentHead; i != end; i++) {
+            handler(slots[i & (Capacity - 1)]);
+            // Release each slot as soon as it is handled so the producer can reuse it
+            head.store(i + 1, std::memory_order_release);
+        }
+        return end - currentHead;
+    }
+
+    // Consumer only. Calls handler(T&) on the oldest item; false if the ring is empty.
+    template<typename Handler>
+    bool tryPop(Handler&& handler) {
+        size_t currentHead = head.load(std::memory_order_relaxed);
+        if (currentHead == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        handler(slots[currentHead & (Capacity - 1)]);
+        head.store(currentHead + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called concurrently with push/drain
+    size_t size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    std::vector<T> slots;
+    alignas(64) std::atomic<size_t> head{0};  // Next slot to read, written by the consumer
+    alignas(64) std::atomic<size_t> tail{0};  // Next slot to write, written by the producer
+};
+
+} // namespace owop
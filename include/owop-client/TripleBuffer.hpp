@@ -0,0 +1,48 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace owop {
+
+// Latest-value handoff for exactly one writer thread and one reader thread.
+// Each side owns one of three slots outright and they trade through the third
+// with a single atomic exchange, so neither side ever waits on the other or
+// touches a slot the other is using. The reader always gets the newest
+// published value; values it never read are simply overwritten.
+template<typename T>
+class TripleBuffer {
+public:
+    explicit TripleBuffer(const T& initial) : slots{initial, initial, initial} {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Writer only. The slot to fill before the next publish().
+    T& back() { return slots[backIndex]; }
+
+    // Writer only. Makes back() the newest value and hands out a free slot.
+    void publish() {
+        uint8_t previous = middle.exchange(static_cast<uint8_t>(backIndex | FRESH), std::memory_order_acq_rel);
+        backIndex = previous & INDEX_MASK;
+    }
+
+    // Reader only. The newest published value, valid until the next read().
+    const T& read() {
+        if (middle.load(std::memory_order_relaxed) & FRESH) {
+            uint8_t previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+            frontIndex = previous & INDEX_MASK;
+        }
+        return slots[frontIndex];
+    }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH = 0x4;  // Set while the middle slot holds a value the reader hasn't taken
+
+    T slots[3];
+    uint8_t frontIndex{0};  // Reader only
+    uint8_t backIndex{2};   // Writer only
+    alignas(64) std::atomic<uint8_t> middle{1};
+};
+
+} // namespace owop
@@ -1,5 +1,10 @@
 #pragma once
+#include <array>
 #include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "Constants.hpp"
 
 namespace owop {
 
@@ -10,6 +15,46 @@ struct Color {
     Color(uint8_t r, uint8_t g, uint8_t b) : r(r), g(g), b(b) {}
 };
 
+// Chunk pixels are stored and uploaded as tightly packed RGB
+static_assert(sizeof(Color) == 3, "Color must be 3 packed bytes");
+
+constexpr size_t CHUNK_PIXEL_COUNT = CHUNK_SIZE * CHUNK_SIZE;
+constexpr size_t CHUNK_PIXEL_BYTES = CHUNK_PIXEL_COUNT * sizeof(Color);
+
+// Pixel updates for a single chunk, grouped on the network thread so the
+// renderer can apply them with one lookup and one texture upload per chunk
+struct PixelBatch {
+    struct Entry {
+        uint8_t index;  // localY * CHUNK_SIZE + localX
+        Color color;
+        uint32_t playerId;  // Who placed it
+    };
+
+    int32_t chunkX;
+    int32_t chunkY;
+    std::vector<Entry> pixels;
+};
+
+// Floor division, so negative world coordinates land in the chunk to their left/top
+inline int32_t floorDiv(int32_t value, int32_t divisor) {
+    int32_t quotient = value / divisor;
+    if ((value % divisor != 0) && ((value < 0) != (divisor < 0))) {
+        quotient--;
+    }
+    return quotient;
+}
+
+// Read-only view of one chunk's pixels straight out of a network message.
+// Only valid for the duration of the callback it is passed to.
+struct ChunkPixelsView {
+    const uint8_t* rgb;  // CHUNK_PIXEL_BYTES bytes, row-major RGB
+};
+
+// One chunk's pixels in a buffer of their own. The network fills it from the
+// message and the renderer adopts it, so a chunk is copied only once.
+using ChunkPixelBuffer = std::array<Color, CHUNK_PIXEL_COUNT>;
+using ChunkPixels = std::unique_ptr<ChunkPixelBuffer>;
+
 struct Vec2 {
     float x, y;
     
@@ -4,7 +4,65 @@
 #include <websocketpp/config/asio_client.hpp>
 #include <websocketpp/client.hpp>
 #include <websocketpp/transport/asio/security/tls.hpp>
+#include <websocketpp/extensions/permessage_deflate/enabled.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
 
-// Define websocket types outside of any namespace
-using WebSocketClient = websocketpp::client<websocketpp::config::asio_tls_client>;
-using WebSocketConnection = websocketpp::connection_hdl; 
\ No newline at end of file
+namespace owop {
+
+// Inbound permessage-deflate traffic, summed over every connection. websocketpp
+// creates the extension per connection without a way to pass state in, so the
+// switch and the counters are process-wide.
+struct DeflateTraffic {
+    static inline std::atomic<bool> offer{true};          // Offer the extension in the next handshake
+    static inline std::atomic<uint64_t> compressedBytes{0}; // Compressed payload bytes fed to inflate
+    static inline std::atomic<uint64_t> inflatedBytes{0};   // Bytes inflate produced from them
+    static inline std::atomic<uint64_t> inflateNanos{0};
+};
+
+} // namespace owop
+
+// websocketpp's permessage-deflate extension with the offer made switchable and
+// inflate counted. The processor calls these by name on the config's
+// permessage_deflate_type, so hiding the base versions is enough.
+template<typename Config>
+class CountingDeflate : public websocketpp::extensions::permessage_deflate::enabled<Config> {
+    using Base = websocketpp::extensions::permessage_deflate::enabled<Config>;
+
+public:
+    std::string generate_offer() const {
+        return owop::DeflateTraffic::offer ? Base::generate_offer() : std::string();
+    }
+
+    websocketpp::lib::error_code decompress(uint8_t const* buf, size_t len, std::string& out) {
+        size_t before = out.size();
+        auto start = std::chrono::steady_clock::now();
+        auto ec = Base::decompress(buf, len, out);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        owop::DeflateTraffic::compressedBytes += len;
+        owop::DeflateTraffic::inflatedBytes += out.size() - before;
+        owop::DeflateTraffic::inflateNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        return ec;
+    }
+};
+
+struct DeflateTlsClientConfig : websocketpp::config::asio_tls_client {
+    typedef DeflateTlsClientConfig type;
+    struct permessage_deflate_config {};
+    typedef CountingDeflate<permessage_deflate_config> permessage_deflate_type;
+};
+
+struct DeflatePlainClientConfig : websocketpp::config::asio_client {
+    typedef DeflatePlainClientConfig type;
+    struct permessage_deflate_config {};
+    typedef CountingDeflate<permessage_deflate_config> permessage_deflate_type;
+};
+
+// Define websocket types outside of any namespace. The transport is picked from
+// the URL scheme: ws:// uses the plain client, wss:// the TLS one.
+using WebSocketTlsClient = websocketpp::client<DeflateTlsClientConfig>;
+using WebSocketPlainClient = websocketpp::client<DeflatePlainClientConfig>;
+using WebSocketConnection = websocketpp::connection_hdl;
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace owop {
+namespace wire {
+
+// The OWOP protocol is little-endian. Reads and writes go through memcpy so they
+// are safe at any alignment; on little-endian hosts they compile to a single
+// unaligned load/store, on big-endian hosts the bytes are swapped afterwards.
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+constexpr bool HOST_IS_LITTLE_ENDIAN = false;
+#else
+constexpr bool HOST_IS_LITTLE_ENDIAN = true;  // MSVC targets and everything else we build for
+#endif
+
+template<typename T>
+inline T byteSwap(T value) {
+    static_assert(std::is_trivially_copyable<T>::value, "byteSwap needs a trivially copyable type");
+    uint8_t bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    for (size_t i = 0; i < sizeof(T) / 2; i++) {
+        uint8_t tmp = bytes[i];
+        bytes[i] = bytes[sizeof(T) - 1 - i];
+        bytes[sizeof(T) - 1 - i] = tmp;
+    }
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+template<typename T>
+inline T readLE(const uint8_t* src) {
+    static_assert(std::is_arithmetic<T>::value, "readLE needs an arithmetic type");
+    T value;
+    std::memcpy(&value, src, sizeof(T));
+    return HOST_IS_LITTLE_ENDIAN ? value : byteSwap(value);
+}
+
+template<typename T>
+inline void writeLE(uint8_t* dst, T value) {
+    static_assert(std::is_arithmetic<T>::value, "writeLE needs an arithmetic type");
+    if (!HOST_IS_LITTLE_ENDIAN) {
+        value = byteSwap(value);
+    }
+    std::memcpy(dst, &value, sizeof(T));
+}
+
+} // namespace wire
+} // namespace owop
@@ -0,0 +1,44 @@
+#pragma once
+#include "../Types.hpp"
+#include <glad/glad.h>
+#include <cstdint>
+#include <vector>
+
+namespace owop {
+
+// Where a chunk's texture lives: a layer of one of the atlas pages
+struct ChunkSlot {
+    uint16_t page = 0;
+    uint16_t layer = 0;
+};
+
+// Chunk textures packed into pages, each a GL_TEXTURE_2D_ARRAY with one
+// 16x16 layer per chunk, so a whole page of chunks is drawn with one texture
+// bound. Pages are added as slots run out; released slots go on a free list
+// and are handed out again before a new page is made. Contents are written by
+// ChunkUploader.
+// Needs a current GL context; the renderer creates it lazily on first use.
+class ChunkAtlas {
+public:
+    ChunkAtlas() = default;
+    ~ChunkAtlas();
+    ChunkAtlas(const ChunkAtlas&) = delete;
+    ChunkAtlas& operator=(const ChunkAtlas&) = delete;
+
+    ChunkSlot allocate();
+    void release(ChunkSlot slot);
+
+    GLuint pageTexture(size_t page) const { return pages[page]; }
+    size_t pageCount() const { return pages.size(); }
+    size_t capacity() const { return pages.size() * layersPerPage; }
+    size_t usedSlots() const { return capacity() - freeSlots.size(); }
+
+private:
+    void addPage();
+
+    std::vector<GLuint> pages;
+    std::vector<ChunkSlot> freeSlots;  // Lowest layer of the newest page on top
+    size_t layersPerPage = 0;          // Set with the first page, from the driver limit
+};
+
+} // namespace owop
@@ -1,37 +1,141 @@
 #pragma once
 #include "../Types.hpp"
 #include "../Camera.hpp"
+#include "../Constants.hpp"
+#include "ChunkAtlas.hpp"
+#include "ChunkUploader.hpp"
+#include "LodBuilder.hpp"
 #include <glad/glad.h>
-#include <vector>
+#include <array>
+#include <functional>
 #include <unordered_map>
+#include <vector>
 #include <GLFW/glfw3.h>
 
 namespace owop {
 
+// What the last frame cost
+struct ChunkRenderStats {
+    size_t drawCalls = 0;      // One instanced draw per atlas page with visible tiles
+    size_t chunksDrawn = 0;    // Tiles, when drawing a coarser LOD level
+    size_t chunksLoaded = 0;
+    int lodLevel = 0;          // 0 draws chunks, each level above a cluster of the one below
+    size_t lodTiles = 0;       // Built LOD tiles over all levels
+    size_t lodPending = 0;     // Chunks waiting for the LOD builder
+    size_t memoryBytes = 0;    // Estimated for the loaded chunks and LOD tiles
+    size_t memoryBudget = 0;
+    uint64_t chunksEvicted = 0;
+    uint64_t lodTilesEvicted = 0;  // Dropped once none of their chunks were loaded
+    size_t textureUploads = 0;
+    size_t uploadBytes = 0;
+    size_t uploadsDeferred = 0;  // Visible dirty chunks left for a later frame by the budget
+    size_t pages = 0;
+    size_t slotsUsed = 0;
+    size_t slotsTotal = 0;
+};
+
 class ChunkRenderer {
 public:
     ChunkRenderer(GLFWwindow* window);
     ~ChunkRenderer();
 
     void render(const Camera& camera, int windowWidth, int windowHeight);
-    void updateChunk(int x, int y, const std::vector<Color>& pixels);
+    // Takes the chunk's new pixels and leaves its previous buffer, if any, in their place
+    void updateChunk(int chunkX, int chunkY, ChunkPixels& pixels);
     void setPixel(int x, int y, const Color& color);
+    // False if the pixel's chunk isn't loaded
+    bool getPixel(int x, int y, Color& color) const;
+
+    void applyPixelBatch(const PixelBatch& batch);
+
+    // Texture bytes one frame may upload; later frames pick up the rest
+    void setUploadBudget(size_t bytes) { uploadBudget = bytes; }
+
+    // Memory loaded chunks and LOD tiles may use; past it the chunks farthest
+    // from the camera are dropped, along with tiles left with none, and their
+    // texture slots reused
+    void setMemoryBudget(size_t bytes) { memoryBudget = bytes; }
+
+    // Called with the chunks dropped to stay within the memory budget
+    void setChunkEvictedCallback(std::function<void(const std::vector<Vec2i>&)> callback) {
+        chunkEvictedCallback = callback;
+    }
+
+    const ChunkRenderStats& getStats() const { return stats; }
 
 private:
     GLFWwindow* window;
-    
+
     struct Chunk {
-        GLuint texture = 0;
-        bool dirty = false;
-        std::vector<Color> pixels;
+        ChunkSlot slot;
+        bool hasSlot = false;  // Allocated with the first upload
+        DirtyRect dirty;
+        bool lodStale = false;  // Changed since last handed to the LOD builder
+        ChunkPixels pixels;  // Adopted from the network for chunks, allocated for LOD tiles
+    };
+
+    // Per-instance vertex data: which chunk, and where its texture is
+    struct Instance {
+        int32_t chunkX;
+        int32_t chunkY;
+        int32_t layer;
     };
 
-    std::unordered_map<uint64_t, Chunk> chunks;
+    // Spatial index over the loaded tiles of one level: a frame only looks up
+    // the clusters under the view, so its cost follows the screen area in
+    // clusters rather than everything loaded or every tile position
+    struct Cluster {
+        std::array<Chunk*, CLUSTER_CHUNK_AMOUNT * CLUSTER_CHUNK_AMOUNT> chunks{};  // Row-major, null if not loaded
+    };
+
+    std::unordered_map<uint64_t, Chunk> chunks;  // Node-based, so Cluster pointers stay valid
+    std::unordered_map<uint64_t, Cluster> clusters[LOD_LEVELS];  // By level; level 0 indexes chunks
+
+    // Downsampled tiles for zoomed-out views, by level; level 0 is the chunks
+    // above. They are stored and uploaded like chunks.
+    std::unordered_map<uint64_t, Chunk> lodTiles[LOD_LEVELS];
+    std::unordered_map<uint64_t, uint32_t> lodSources[LOD_LEVELS];  // Loaded chunks under each tile, by level
+    size_t lodTileCount = 0;  // Over all levels
+    std::vector<uint64_t> lodStaleChunks;  // Keys of chunks with lodStale set
+    std::vector<LodTile> lodResults;       // Reused every frame
+    ChunkAtlas atlas;
+    ChunkUploader uploader;
+    LodBuilder lodBuilder;
+    size_t uploadBudget = static_cast<size_t>(CHUNK_UPLOAD_BUDGET_KIB) * 1024;
+    size_t memoryBudget = static_cast<size_t>(CHUNK_MEMORY_BUDGET_MIB) * 1024 * 1024;
+    std::function<void(const std::vector<Vec2i>&)> chunkEvictedCallback;
+    std::vector<std::pair<int64_t, uint64_t>> evictionOrder;  // Squared distance, chunk key; reused
+    std::vector<Vec2i> evicted;                               // Reused
+    ChunkRenderStats stats;
+
+    // GL objects, created on the first render once the context exists
+    GLuint program = 0;
+    GLuint vertexArray = 0;
+    GLuint quadBuffer = 0;
+    GLuint instanceBuffer = 0;
+    GLint viewOriginTileLocation = -1;
+    GLint tileSizeLocation = -1;
+    GLint viewOriginOffsetLocation = -1;
+    GLint viewScaleLocation = -1;
+    std::vector<std::vector<Instance>> pageInstances;  // Visible chunks per page, reused every frame
+    std::vector<Instance> instanceData;                // All pages back to back, as uploaded
 
-    void updateChunkTexture(Chunk& chunk);
+    bool initGL();
+    void markLodStale(Chunk& chunk, int chunkX, int chunkY);
+    void updateLod();
+    void evictChunks(int centerChunkX, int centerChunkY);
+    // Keep lodSources in step with a chunk loaded (+1) or evicted (-1)
+    void countLodSources(int chunkX, int chunkY, int delta);
+    void addInstance(Chunk& tile, int32_t tileX, int32_t tileY);
+    // Point the level's cluster index at a tile, or with null clear its entry
+    void indexTile(int level, int tileX, int tileY, Chunk* tile);
+    // Add the level's loaded tiles within the inclusive tile range
+    void addVisibleTiles(int level, int minTileX, int minTileY, int maxTileX, int maxTileY);
+    // Stage the chunk's dirty rectangle if the budget allows; false if it has nothing to draw yet
+    bool updateChunkTexture(Chunk& chunk);
     uint64_t getChunkKey(int x, int y) const {
         return (static_cast<uint64_t>(x) << 32) | static_cast<uint32_t>(y);
     }
 };
 
-} // namespace owop 
\ No newline at end of file
+} // namespace owop
@@ -0,0 +1,78 @@
+#pragma once
+#include "../Types.hpp"
+#include "ChunkAtlas.hpp"
+#include <glad/glad.h>
+#include <cstdint>
+#include <vector>
+
+namespace owop {
+
+// Changed part of a chunk in chunk-local pixels, inclusive; empty when clean
+struct DirtyRect {
+    uint8_t minX = CHUNK_SIZE;
+    uint8_t minY = CHUNK_SIZE;
+    uint8_t maxX = 0;
+    uint8_t maxY = 0;
+
+    bool empty() const { return minX > maxX; }
+    size_t width() const { return maxX - minX + 1; }
+    size_t height() const { return maxY - minY + 1; }
+    size_t byteCount() const { return empty() ? 0 : width() * height() * sizeof(Color); }
+
+    void add(int x, int y) {
+        if (x < minX) minX = static_cast<uint8_t>(x);
+        if (y < minY) minY = static_cast<uint8_t>(y);
+        if (x > maxX) maxX = static_cast<uint8_t>(x);
+        if (y > maxY) maxY = static_cast<uint8_t>(y);
+    }
+    void addAll() { *this = DirtyRect{0, 0, CHUNK_SIZE - 1, CHUNK_SIZE - 1}; }
+    void clear() { *this = DirtyRect{}; }
+};
+
+// Streams chunk texture updates to the atlas through pixel buffer objects.
+// Each frame the dirty rectangles are packed into the next buffer of a small
+// ring, so the CPU never writes a buffer the GPU may still be reading, and are
+// then copied into their atlas layers with glTexSubImage3D. A byte budget caps
+// how much one frame stages; the rest waits for the next frame.
+// Needs a current GL context; main thread only.
+class ChunkUploader {
+public:
+    ChunkUploader() = default;
+    ~ChunkUploader();
+    ChunkUploader(const ChunkUploader&) = delete;
+    ChunkUploader& operator=(const ChunkUploader&) = delete;
+
+    void beginFrame(size_t budgetBytes);
+
+    // Whether a rectangle of this many bytes still fits this frame. The first
+    // one always does, so a budget below one chunk can't stall uploads.
+    bool hasRoom(size_t bytes) const { return used == 0 || used + bytes <= budget; }
+
+    // Copy the rectangle out of the chunk's pixels into the staging buffer
+    bool stage(ChunkSlot slot, const Color* pixels, const DirtyRect& rect);
+
+    // Copy everything staged this frame into the atlas
+    void endFrame(const ChunkAtlas& atlas);
+
+    size_t stagedBytes() const { return used; }
+    size_t stagedCount() const { return uploads.size(); }
+
+private:
+    struct Upload {
+        ChunkSlot slot;
+        DirtyRect rect;
+        size_t offset;  // Into the staging buffer
+    };
+
+    bool mapNextBuffer();
+
+    GLuint buffers[CHUNK_UPLOAD_RING_SIZE] = {};
+    size_t bufferSizes[CHUNK_UPLOAD_RING_SIZE] = {};
+    size_t current = 0;
+    size_t budget = 0;
+    size_t used = 0;
+    uint8_t* mapped = nullptr;  // Mapped lazily, on the first stage of a frame
+    std::vector<Upload> uploads;
+};
+
+} // namespace owop
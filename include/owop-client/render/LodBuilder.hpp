@@ -0,0 +1,75 @@
+#pragma once
+#include "../Types.hpp"
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace owop {
+
+using TilePixels = std::array<Color, CHUNK_PIXEL_COUNT>;
+
+// One 16x16 tile of the level-of-detail pyramid. A level 1 tile covers a
+// cluster of CLUSTER_CHUNK_AMOUNT x CLUSTER_CHUNK_AMOUNT chunks, a level 2 tile
+// a cluster of level 1 tiles, and so on; x and y count tiles of that level.
+struct LodTile {
+    int level;
+    int32_t x;
+    int32_t y;
+    TilePixels pixels;
+};
+
+// Builds the LOD pyramid on a worker thread. The main thread submits chunks as
+// they arrive or change; the worker folds each one into its level 1 tile and
+// every changed tile into the level above, then hands the rebuilt tiles back.
+// Only the touched 2x2 block of each parent is recomputed, so a pixel edit
+// costs one chunk's worth of averaging per level.
+class LodBuilder {
+public:
+    LodBuilder();
+    ~LodBuilder();
+    LodBuilder(const LodBuilder&) = delete;
+    LodBuilder& operator=(const LodBuilder&) = delete;
+
+    // Main thread: a chunk's pixels changed. Resubmitting a chunk still
+    // waiting replaces its pixels.
+    void submit(int32_t chunkX, int32_t chunkY, const TilePixels& pixels);
+
+    // Main thread: none of the tile's chunks are loaded any more; forget it.
+    // Chunks of it submitted later start it afresh.
+    void drop(int level, int32_t tileX, int32_t tileY);
+
+    // Main thread: move the tiles rebuilt since the last call into out
+    void takeResults(std::vector<LodTile>& out);
+
+    size_t pendingCount() const;
+
+private:
+    // A changed chunk, or with dropLevel set a tile to forget. Jobs run in
+    // the order they were queued.
+    struct Job {
+        int32_t chunkX;
+        int32_t chunkY;
+        TilePixels pixels;
+        int dropLevel = 0;  // Chunk x and y are the tile's at this level
+    };
+
+    void run();
+    void build(std::vector<Job>::const_iterator first, std::vector<Job>::const_iterator last);
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<Job> jobs;                          // Guarded by mutex
+    std::unordered_map<uint64_t, size_t> jobIndex;  // Guarded by mutex; chunk key -> index in jobs
+    std::vector<LodTile> results;                   // Guarded by mutex
+    bool stopping{false};                           // Guarded by mutex
+
+    // The pyramid itself; worker thread only. Level 0 (the chunks) is not kept.
+    std::unordered_map<uint64_t, TilePixels> levels[LOD_LEVELS];
+    std::thread worker;
+};
+
+} // namespace owop
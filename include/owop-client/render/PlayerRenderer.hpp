@@ -0,0 +1,30 @@
+#pragma once
+#include "../Camera.hpp"
+#include "../Player.hpp"
+#include <glad/glad.h>
+#include <chrono>
+
+namespace owop {
+
+// Draws other players' cursors. Positions are interpolated between the last two
+// snapshots, so cursors move at display rate while worldUpdate arrives at the
+// server's (lower) tick rate.
+class PlayerRenderer {
+public:
+    PlayerRenderer();
+
+    // Call once per frame with the latest snapshot from Network::getPlayers()
+    void update(const PlayerSnapshotPtr& latest);
+    void render(const Camera& camera, int windowWidth, int windowHeight);
+
+    size_t getPlayerCount() const { return current ? current->players.size() : 0; }
+
+private:
+    PlayerSnapshotPtr previous;
+    PlayerSnapshotPtr current;
+
+    // Fraction of the way from previous to current at the given time, 0..1
+    float getInterpolation(std::chrono::steady_clock::time_point now) const;
+};
+
+} // namespace owop
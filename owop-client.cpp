@@ -8,14 +8,20 @@
 #include <owop-client/Mouse.hpp>
 #include <owop-client/Network.hpp>
 #include <owop-client/render/ChunkRenderer.hpp>
+#include <owop-client/render/PlayerRenderer.hpp>
 #include <owop-client/Constants.hpp>
 #include <owop-client/Logger.hpp>
 #include <owop-client/Types.hpp>
 #include <owop-client/Settings.hpp>
+#include <owop-client/Protocol.hpp>
+#include <owop-client/PendingPixelWrites.hpp>
 
 #include <iostream>
 #include <stdexcept>
 #include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <chrono>
 
 static void glfwErrorCallback(int error, const char* description) {
     owop::Logger::error("GLFW", std::string("Error ") + std::to_string(error) + ": " + description);
@@ -28,12 +34,18 @@ private:
     owop::Mouse mouse;
     bool showTools = true;
     
-    owop::Tool currentTool = owop::Tool::Cursor;
+    owop::Tool currentTool = owop::Tool::Move;  // Painting is opt-in
     ImVec4 currentColor = ImVec4(0, 0, 0, 1);
     
     owop::Network network;
     owop::ChunkRenderer chunkRenderer;
+    owop::PlayerRenderer playerRenderer;
+    owop::PendingPixelWrites pendingWrites;  // Drawn locally, waiting for the server's echo
+    std::chrono::steady_clock::time_point pixelQueueBusyAt;  // Last frame the outbound pixel queue wasn't empty
     
+    int lastPlacedX{0};
+    int lastPlacedY{0};
+
     int windowWidth{800};
     int windowHeight{600};
     
@@ -147,14 +159,117 @@ private:
         if (ImGui::Checkbox("Captcha", &settings.requireCaptcha)) {
             // Setting changed
         }
+
+        // Applied on the next connect
+        ImGui::SliderInt("Max chunks in flight", &settings.maxChunksInFlight, owop::CHUNK_WINDOW_MIN, 256);
+        ImGui::Checkbox("Compress traffic (permessage-deflate)", &settings.compressTraffic);
+        ImGui::SliderInt("Texture upload KiB/frame", &settings.uploadBudgetKiB, 1, 4096);
+        ImGui::SliderInt("Chunk memory MiB", &settings.chunkMemoryMiB, owop::CHUNK_MEMORY_MIN_MIB, 4096);
         
         if (ImGui::Button("Connect")) {
-            network.connect("wss://" + settings.serverDomain, settings.worldName);
+            // A bare host name means wss://; ws:// skips TLS for local or LAN servers
+            std::string url = settings.serverDomain.find("://") == std::string::npos
+                ? "wss://" + settings.serverDomain
+                : settings.serverDomain;
+            network.connect(url, settings.worldName);
         }
         
         ImGui::End();
     }
 
+    void renderNetworkStatsWindow() {
+        ImGui::SetNextWindowPos(ImVec2(430, 40), ImGuiCond_FirstUseEver);
+        ImGui::SetNextWindowSize(ImVec2(220, 140), ImGuiCond_FirstUseEver);
+        ImGui::Begin("Network", nullptr, ImGuiWindowFlags_NoCollapse);
+
+        auto connection = network.getConnectionStats();
+        if (connection.reconnecting) {
+            ImGui::Text("Reconnecting (attempt %d)", connection.reconnectAttempt);
+        } else {
+            ImGui::Text("%s", owop::toString(connection.state));
+        }
+        ImGui::Text("Last connect %.0f ms, captcha %.0f ms, join %.0f ms",
+            connection.phaseMs[static_cast<size_t>(owop::SessionState::Connecting)],
+            connection.phaseMs[static_cast<size_t>(owop::SessionState::Captcha)],
+            connection.phaseMs[static_cast<size_t>(owop::SessionState::Joining)]);
+        if (connection.tls) {
+            ImGui::Text("TLS handshakes: %llu (%llu resumed)",
+                static_cast<unsigned long long>(connection.tlsHandshakes),
+                static_cast<unsigned long long>(connection.tlsResumptions));
+        }
+
+        auto compression = network.getCompressionStats();
+        if (connection.connected) {
+            ImGui::Text("Deflate: %s", compression.negotiated ? "on" : (compression.offered ? "declined by server" : "off"));
+        }
+        ImGui::Text("Received: %.1f KiB on the wire, %.1f KiB inflated (%.1f ms)",
+            compression.wireBytes / 1024.0, compression.payloadBytes / 1024.0, compression.inflateMs);
+
+        auto send = network.getSendStats();
+        ImGui::Text("Send buffer: %.1f / %.0f KiB (peak %.1f KiB)  Stalls: %llu", send.bufferedBytes / 1024.0,
+            send.highWater / 1024.0, send.peakBufferedBytes / 1024.0, static_cast<unsigned long long>(send.stalls));
+        ImGui::Text("Cursor moves: %llu sent, %llu coalesced",
+            static_cast<unsigned long long>(send.movesSent),
+            static_cast<unsigned long long>(send.movesCoalesced));
+        for (size_t i = 0; i < owop::SEND_LANE_COUNT; i++) {
+            const auto& lane = send.lanes[i];
+            ImGui::Text("  %-15s %4zu queued (peak %zu)  %llu sent  wait %.1f ms (max %.0f)",
+                owop::toString(static_cast<owop::SendLane>(i)), lane.queuedFrames, lane.peakQueuedFrames,
+                static_cast<unsigned long long>(lane.sent), lane.avgWaitMs, lane.maxWaitMs);
+        }
+
+        auto stats = network.getChunkPipelineStats();
+        ImGui::Text("Chunks/s: %.1f", stats.chunksPerSecond);
+        ImGui::Text("In flight: %zu / %zu", stats.inFlight, stats.window);
+        ImGui::Text("Queued: %zu", stats.queued);
+        ImGui::Text("RTT: %.0f ms (min %.0f ms)", stats.smoothedRttMs, stats.minRttMs);
+        ImGui::Text("Received: %llu", static_cast<unsigned long long>(stats.received));
+        ImGui::Text("Cancelled: %llu (%.1f KiB saved)", static_cast<unsigned long long>(stats.cancelled),
+            stats.cancelled * owop::protocol::CHUNK_MESSAGE_SIZE / 1024.0);
+        ImGui::Text("Timeouts: %llu  Retries: %llu  Abandoned: %llu",
+            static_cast<unsigned long long>(stats.timeouts),
+            static_cast<unsigned long long>(stats.retries),
+            static_cast<unsigned long long>(stats.abandoned));
+
+        auto queue = network.getEventQueueStats();
+        ImGui::Text("Event queue: %zu / %zu (peak %zu)", queue.depth, queue.capacity, queue.peakDepth);
+        ImGui::Text("Event overflows: %llu", static_cast<unsigned long long>(queue.overflows));
+        ImGui::Text("Players: %zu", playerRenderer.getPlayerCount());
+
+        const auto& render = chunkRenderer.getStats();
+        ImGui::Text("Chunks drawn: %zu of %zu in %zu draw calls", render.chunksDrawn, render.chunksLoaded,
+            render.drawCalls);
+        ImGui::Text("Texture uploads: %zu (%.1f KiB), %zu waiting", render.textureUploads,
+            render.uploadBytes / 1024.0, render.uploadsDeferred);
+        ImGui::Text("Atlas: %zu pages, %zu / %zu slots", render.pages, render.slotsUsed, render.slotsTotal);
+        ImGui::Text("LOD level %d: %zu tiles built, %zu chunks waiting", render.lodLevel, render.lodTiles,
+            render.lodPending);
+        ImGui::Text("Chunk memory: %.1f / %.0f MiB, %llu evicted, %llu LOD tiles", render.memoryBytes / (1024.0 * 1024.0),
+            render.memoryBudget / (1024.0 * 1024.0), static_cast<unsigned long long>(render.chunksEvicted),
+            static_cast<unsigned long long>(render.lodTilesEvicted));
+
+        auto pixels = network.getPixelWriteStats();
+        ImGui::Text("Pixel quota: %u / %us (%.1f ready)", pixels.quotaRate, pixels.quotaPer, pixels.tokens);
+        ImGui::Text("Pixels pending: %zu  Sent: %llu", pixels.pending, static_cast<unsigned long long>(pixels.sent));
+        ImGui::Text("Coalesced: %llu  Dropped: %llu",
+            static_cast<unsigned long long>(pixels.coalesced),
+            static_cast<unsigned long long>(pixels.dropped));
+
+        const auto& latency = pendingWrites.getLatency();
+        ImGui::Text("Unconfirmed: %zu  Confirmed: %llu  Rolled back: %llu", pendingWrites.size(),
+            static_cast<unsigned long long>(pendingWrites.confirmedCount()),
+            static_cast<unsigned long long>(pendingWrites.rolledBackCount()));
+        ImGui::Text("Confirm latency p50 < %.0f ms  p99 < %.0f ms", latency.percentile(0.5), latency.percentile(0.99));
+        float histogram[owop::LatencyHistogram::BUCKET_COUNT];
+        for (size_t i = 0; i < owop::LatencyHistogram::BUCKET_COUNT; i++) {
+            histogram[i] = static_cast<float>(latency.buckets[i]);
+        }
+        ImGui::PlotHistogram("##latency", histogram, static_cast<int>(owop::LatencyHistogram::BUCKET_COUNT),
+            0, "1 ms .. 32 s (log2)", 0.0f, FLT_MAX, ImVec2(0, 40));
+
+        ImGui::End();
+    }
+
     void renderCoordinates() {
         auto tilePos = mouse.getTilePosition();
         ImGui::SetNextWindowPos(ImVec2(10, 10));
@@ -185,8 +300,27 @@ public:
         owop::Settings::getInstance().load();
         
         // Set up chunk data callback
-        network.setChunkDataCallback([this](int x, int y, const std::vector<owop::Color>& colors) {
-            chunkRenderer.updateChunk(x, y, colors);
+        network.setChunkDataCallback([this](int x, int y, owop::ChunkPixels& pixels) {
+            chunkRenderer.updateChunk(x, y, pixels);
+        });
+
+        // Live pixel updates arrive grouped per chunk
+        network.setPixelBatchCallback([this](const owop::PixelBatch& batch) {
+            chunkRenderer.applyPixelBatch(batch);
+            if (!pendingWrites.empty()) {
+                confirmPixelWrites(batch);
+            }
+        });
+
+        // The server can move us, e.g. on a moderator's /tp
+        network.setTeleportCallback([this](int32_t x, int32_t y) {
+            camera.moveTo(static_cast<float>(x), static_cast<float>(y));
+            network.requestChunksInView(camera.getX(), camera.getY(), camera.getZoom(), windowWidth, windowHeight);
+        });
+
+        // Chunks dropped for memory can be fetched again
+        chunkRenderer.setChunkEvictedCallback([this](const std::vector<owop::Vec2i>& evicted) {
+            network.forgetChunks(evicted);
         });
     }
 
@@ -206,11 +340,17 @@ public:
         owop::Logger::info("OWOPClient", "Starting main loop...");
 
         // Initial chunk request
-        network.requestChunksInView(camera.getX(), camera.getY(), camera.getZoom());
+        network.requestChunksInView(camera.getX(), camera.getY(), camera.getZoom(), windowWidth, windowHeight);
 
         // Main loop
         while (!glfwWindowShouldClose(window)) {
             glfwPollEvents();
+            glfwGetFramebufferSize(window, &windowWidth, &windowHeight);
+
+            // Apply chunks and pixel updates received by the network thread since the last frame
+            network.dispatchEvents();
+            playerRenderer.update(network.getPlayers());
+            expirePixelWrites();
             ImGui_ImplOpenGL3_NewFrame();
             ImGui_ImplGlfw_NewFrame();
             ImGui::NewFrame();
@@ -221,6 +361,8 @@ public:
             static bool showSettings = true;
             renderSettingsWindow(showSettings);
 
+            renderNetworkStatsWindow();
+
             renderCoordinates();
 
             // Clear screen
@@ -228,7 +370,12 @@ public:
             glClear(GL_COLOR_BUFFER_BIT);
 
             // Render chunks
+            size_t memoryBudget = static_cast<size_t>(owop::Settings::getInstance().chunkMemoryMiB) * 1024 * 1024;
+            chunkRenderer.setUploadBudget(static_cast<size_t>(owop::Settings::getInstance().uploadBudgetKiB) * 1024);
+            chunkRenderer.setMemoryBudget(memoryBudget);
+            fitMinZoom(memoryBudget);
             chunkRenderer.render(camera, windowWidth, windowHeight);
+            playerRenderer.render(camera, windowWidth, windowHeight);
 
             // Render ImGui
             ImGui::Render();
@@ -237,13 +384,21 @@ public:
             // Swap buffers
             glfwSwapBuffers(window);
 
-            // Handle camera movement
-            if (ImGui::IsMouseDragging(ImGuiMouseButton_Left)) {
+            bool mouseOverUi = ImGui::GetIO().WantCaptureMouse;
+
+            // Place pixels with the cursor tool
+            if (currentTool == owop::Tool::Cursor && ImGui::IsMouseDown(ImGuiMouseButton_Left) && !mouseOverUi) {
+                placePixelAtMouse();
+            }
+
+            // Handle camera movement; the middle button pans with any tool
+            else if (!mouseOverUi && (ImGui::IsMouseDragging(ImGuiMouseButton_Left) ||
+                                      ImGui::IsMouseDragging(ImGuiMouseButton_Middle))) {
                 ImVec2 delta = ImGui::GetIO().MouseDelta;
                 camera.move(-delta.x / camera.getZoom(), -delta.y / camera.getZoom());
                 
                 // Request chunks for new camera position
-                network.requestChunksInView(camera.getX(), camera.getY(), camera.getZoom());
+                network.requestChunksInView(camera.getX(), camera.getY(), camera.getZoom(), windowWidth, windowHeight);
             }
 
             // Handle zoom
@@ -254,8 +409,8 @@ public:
                 float worldX = (mousePos.x - windowWidth/2) / camera.getZoom() + camera.getX();
                 float worldY = (mousePos.y - windowHeight/2) / camera.getZoom() + camera.getY();
                 
-                // Apply zoom
-                camera.zoom(wheel * 0.1f);
+                // Apply zoom, in steps proportional to the current zoom so far out stays usable
+                camera.zoom(camera.getZoom() * wheel * 0.1f);
                 
                 // Adjust position to keep mouse point fixed
                 camera.moveTo(
@@ -264,12 +419,100 @@ public:
                 );
                 
                 // Request chunks for new zoom level
-                network.requestChunksInView(camera.getX(), camera.getY(), camera.getZoom());
+                network.requestChunksInView(camera.getX(), camera.getY(), camera.getZoom(), windowWidth, windowHeight);
             }
+
+            sendCursorPosition();
         }
     }
 
 private:
+    // Chunks are fetched one by one, so the view can only be as large as the
+    // memory budget holds; zooming out stops there rather than showing an
+    // empty screen around what fits
+    void fitMinZoom(size_t memoryBudget) {
+        float maxChunks = static_cast<float>(memoryBudget / owop::CHUNK_MEMORY_VIEW_COST);
+        float viewPixels = static_cast<float>(windowWidth) * windowHeight;  // The cost's headroom covers the prefetch ring
+        float previous = camera.getZoom();
+        camera.setMinZoom(std::sqrt(viewPixels / (owop::CHUNK_PIXEL_COUNT * maxChunks)));
+        if (camera.getZoom() != previous) {
+            network.requestChunksInView(camera.getX(), camera.getY(), camera.getZoom(), windowWidth, windowHeight);
+        }
+    }
+
+    void placePixelAtMouse() {
+        ImVec2 mousePos = ImGui::GetMousePos();
+        int pixelX = static_cast<int>(std::floor((mousePos.x - windowWidth / 2) / camera.getZoom() + camera.getX()));
+        int pixelY = static_cast<int>(std::floor((mousePos.y - windowHeight / 2) / camera.getZoom() + camera.getY()));
+
+        owop::Color color = selectedColor();
+
+        // Holding the button over one pixel only queues it once
+        if (pixelX == lastPlacedX && pixelY == lastPlacedY && !ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
+            return;
+        }
+        lastPlacedX = pixelX;
+        lastPlacedY = pixelY;
+
+        if (!network.placePixel(pixelX, pixelY, color)) return;
+
+        // Show the write right away; it is confirmed or rolled back once the server answers
+        owop::Color previous;
+        if (chunkRenderer.getPixel(pixelX, pixelY, previous) &&
+            (previous.r != color.r || previous.g != color.g || previous.b != color.b)) {
+            pendingWrites.add(pixelX, pixelY, color, previous, std::chrono::steady_clock::now());
+            chunkRenderer.setPixel(pixelX, pixelY, color);
+        }
+    }
+
+    owop::Color selectedColor() const {
+        return owop::Color(
+            static_cast<uint8_t>(currentColor.x * 255),
+            static_cast<uint8_t>(currentColor.y * 255),
+            static_cast<uint8_t>(currentColor.z * 255));
+    }
+
+    // Let other players see our cursor; Network decides when a move is due
+    void sendCursorPosition() {
+        // Mouse works in 1/16 pixel units relative to the camera, which sits at the window center
+        ImVec2 mousePos = ImGui::GetMousePos();
+        mouse.update(mousePos.x - windowWidth / 2, mousePos.y - windowHeight / 2);
+
+        owop::Vec2 world = mouse.getWorldPosition();
+        network.moveCursor(static_cast<int32_t>(std::floor(world.x)), static_cast<int32_t>(std::floor(world.y)),
+            selectedColor(), static_cast<uint8_t>(currentTool));
+    }
+
+    void confirmPixelWrites(const owop::PixelBatch& batch) {
+        auto now = std::chrono::steady_clock::now();
+        uint32_t ourId = network.getPlayerId();
+
+        for (const auto& entry : batch.pixels) {
+            int x = batch.chunkX * owop::CHUNK_SIZE + entry.index % owop::CHUNK_SIZE;
+            int y = batch.chunkY * owop::CHUNK_SIZE + entry.index / owop::CHUNK_SIZE;
+
+            // Keep our newer write on top of whatever the server just applied
+            owop::Color display;
+            if (pendingWrites.onServerUpdate(x, y, entry.color, entry.playerId == ourId, now, display)) {
+                chunkRenderer.setPixel(x, y, display);
+            }
+        }
+    }
+
+    void expirePixelWrites() {
+        if (pendingWrites.empty()) return;
+
+        auto now = std::chrono::steady_clock::now();
+        if (network.getPixelWriteStats().pending > 0) {
+            pixelQueueBusyAt = now;
+        }
+
+        pendingWrites.expire(now, pixelQueueBusyAt, std::chrono::milliseconds(owop::PIXEL_CONFIRM_TIMEOUT_MS),
+            [this](int32_t x, int32_t y, const owop::Color& color) {
+                chunkRenderer.setPixel(x, y, color);
+            });
+    }
+
     void initWindow() {
         try {
             owop::Logger::info("OWOPClient", "Starting initialization...");
@@ -0,0 +1,290 @@
+// Heap allocations per chunk on the chunkLoad path, before and after the
+// zero-copy change.
+//
+// "before" replays what the client used to do with every chunkLoad message:
+// decode it into a std::vector<Color> with 256 push_backs, build the log line,
+// and copy the vector into the renderer's per-chunk vector. "after" runs the
+// current path: protocol::decode and a copy into a pooled pixel buffer passed
+// through the event ring (as NetworkImpl does on the websocket thread), then
+// ChunkRenderer::updateChunk adopting that buffer and its old one going back
+// to the pool (as the main thread does). The pixels are copied once.
+// Global operator new is replaced to count every allocation.
+//
+// Each path loads every chunk once (first pass: map nodes are created) and then
+// reloads them all (--passes - 1 more times), which is the steady state while
+// panning over a loaded area or refetching.
+//
+//   chunk-bench [--chunks 4096] [--passes 8] [--world-file chunks.bin]
+//
+// --world-file takes the same back-to-back chunkLoad messages as mock-server;
+// without it the chunks are generated.
+
+#include <owop-client/Protocol.hpp>
+#include <owop-client/ProtocolDecoder.hpp>
+#include <owop-client/SpscRing.hpp>
+#include <owop-client/render/ChunkRenderer.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+std::atomic<uint64_t> allocationCount{0};
+std::atomic<uint64_t> allocationBytes{0};
+
+} // namespace
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+using namespace owop;
+using Frame = std::array<uint8_t, protocol::CHUNK_MESSAGE_SIZE>;
+
+struct Options {
+    int chunks = 4096;
+    int passes = 8;
+    std::string worldFile;
+};
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        const char* value = argv[i + 1];
+
+        if (arg == "--chunks") {
+            options.chunks = std::atoi(value);
+        } else if (arg == "--passes") {
+            options.passes = std::atoi(value);
+        } else if (arg == "--world-file") {
+            options.worldFile = value;
+        } else {
+            return false;
+        }
+    }
+    return argc % 2 == 1 && options.chunks > 0 && options.passes > 0;
+}
+
+// A square of chunks around the origin with a per-chunk gradient
+std::vector<Frame> generateFrames(int count) {
+    std::vector<Frame> frames(count);
+    int side = 1;
+    while (side * side < count) side++;
+
+    for (int i = 0; i < count; i++) {
+        int32_t x = i % side - side / 2;
+        int32_t y = i / side - side / 2;
+        Frame& frame = frames[i];
+        protocol::ChunkLoadHeaderLayout::encode(frame.data(), protocol::ChunkLoadHeaderLayout::OPCODE, x, y, 0);
+        for (size_t p = 0; p < CHUNK_PIXEL_BYTES; p++) {
+            frame[protocol::ChunkLoadHeaderLayout::SIZE + p] = static_cast<uint8_t>(x * 31 + y * 17 + p);
+        }
+    }
+    return frames;
+}
+
+bool loadFrames(const std::string& path, std::vector<Frame>& frames) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    Frame frame;
+    while (file.read(reinterpret_cast<char*>(frame.data()), frame.size())) {
+        if (frame[0] == protocol::ChunkLoadHeaderLayout::OPCODE) {
+            frames.push_back(frame);
+        }
+    }
+    return !frames.empty();
+}
+
+struct PassResult {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+    double seconds = 0.0;
+};
+
+template<typename LoadChunk>
+PassResult runPass(const std::vector<Frame>& frames, LoadChunk&& loadChunk) {
+    uint64_t countBefore = allocationCount.load(std::memory_order_relaxed);
+    uint64_t bytesBefore = allocationBytes.load(std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+
+    for (const Frame& frame : frames) {
+        loadChunk(frame);
+    }
+
+    PassResult result;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.allocations = allocationCount.load(std::memory_order_relaxed) - countBefore;
+    result.bytes = allocationBytes.load(std::memory_order_relaxed) - bytesBefore;
+    return result;
+}
+
+void report(const char* name, const PassResult& first, const PassResult& steady, size_t chunks, int steadyPasses) {
+    double steadyChunks = static_cast<double>(chunks) * steadyPasses;
+    std::printf("%-8s first load  %6.2f allocs/chunk %8.1f bytes/chunk\n", name,
+        static_cast<double>(first.allocations) / chunks, static_cast<double>(first.bytes) / chunks);
+    if (steadyPasses > 0) {
+        std::printf("%-8s reload      %6.2f allocs/chunk %8.1f bytes/chunk %8.1f ns/chunk\n", name,
+            steady.allocations / steadyChunks, steady.bytes / steadyChunks, steady.seconds * 1e9 / steadyChunks);
+    }
+}
+
+// The chunkLoad path as it was: a decoded vector per chunk, a log line, and a
+// vector copy into the renderer's map
+class LegacyChunkPath {
+public:
+    void load(const Frame& frame) {
+        const uint8_t* payload = frame.data();
+        int32_t chunkX;
+        int32_t chunkY;
+        std::memcpy(&chunkX, payload + 1, sizeof(chunkX));
+        std::memcpy(&chunkY, payload + 5, sizeof(chunkY));
+
+        std::vector<Color> chunkData;
+        chunkData.reserve(256);
+        const uint8_t* data = payload + 10;
+        for (size_t i = 0; i < 768; i += 3) {
+            chunkData.push_back(Color(data[i], data[i + 1], data[i + 2]));
+        }
+
+        // The renderer logged every update
+        std::string line = "Updated chunk at (" + std::to_string(chunkX) + ", " + std::to_string(chunkY) +
+            ") with " + std::to_string(chunkData.size()) + " pixels";
+        logBytes += line.size();
+
+        uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(chunkX)) << 32) | static_cast<uint32_t>(chunkY);
+        chunks[key] = chunkData;
+    }
+
+    size_t logBytes = 0;  // Keeps the log line from being optimized away
+
+private:
+    std::unordered_map<uint64_t, std::vector<Color>> chunks;
+};
+
+// The chunkLoad path as it is now, minus the socket
+class ChunkPath : private protocol::MessageHandler {
+public:
+    ChunkPath() : renderer(nullptr) {}
+
+    void load(const Frame& frame) {
+        // Websocket thread: decode and copy into a pooled buffer
+        protocol::decode(frame.data(), frame.size(), *this);
+
+        // Main thread: the renderer adopts the buffer and its old one is reused
+        events.drain([this](Event& event) {
+            renderer.updateChunk(event.chunkX, event.chunkY, event.pixels);
+            if (event.pixels) {
+                freeBuffers.tryPush([&event](ChunkPixels& slot) { slot = std::move(event.pixels); });
+            }
+        });
+    }
+
+private:
+    struct Event {
+        int32_t chunkX;
+        int32_t chunkY;
+        ChunkPixels pixels;
+    };
+
+    void onChunkLoad(const protocol::ChunkLoadMessage& msg) override {
+        events.tryPush([this, &msg](Event& event) {
+            event.chunkX = msg.x;
+            event.chunkY = msg.y;
+            if (!event.pixels) {
+                freeBuffers.tryPop([&event](ChunkPixels& slot) { event.pixels = std::move(slot); });
+            }
+            if (!event.pixels) {
+                event.pixels = std::make_unique<ChunkPixelBuffer>();
+            }
+            std::memcpy(event.pixels->data(), msg.pixels.rgb, CHUNK_PIXEL_BYTES);
+        });
+    }
+
+    SpscRing<Event, 16> events;
+    SpscRing<ChunkPixels, 16> freeBuffers;
+    ChunkRenderer renderer;  // Never renders, so it needs no GL context
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "usage: chunk-bench [--chunks N] [--passes N] [--world-file FILE]\n");
+        return 1;
+    }
+
+    std::vector<Frame> frames;
+    if (!options.worldFile.empty()) {
+        if (!loadFrames(options.worldFile, frames)) {
+            std::fprintf(stderr, "Could not read chunkLoad messages from %s\n", options.worldFile.c_str());
+            return 1;
+        }
+    } else {
+        frames = generateFrames(options.chunks);
+    }
+    int steadyPasses = options.passes - 1;
+    std::printf("%zu chunks, %d passes\n", frames.size(), options.passes);
+
+    {
+        LegacyChunkPath legacy;
+        PassResult first = runPass(frames, [&legacy](const Frame& frame) { legacy.load(frame); });
+        PassResult steady;
+        for (int pass = 0; pass < steadyPasses; pass++) {
+            PassResult result = runPass(frames, [&legacy](const Frame& frame) { legacy.load(frame); });
+            steady.allocations += result.allocations;
+            steady.bytes += result.bytes;
+            steady.seconds += result.seconds;
+        }
+        report("before", first, steady, frames.size(), steadyPasses);
+    }
+
+    {
+        auto path = std::make_unique<ChunkPath>();
+        PassResult first = runPass(frames, [&path](const Frame& frame) { path->load(frame); });
+        PassResult steady;
+        for (int pass = 0; pass < steadyPasses; pass++) {
+            PassResult result = runPass(frames, [&path](const Frame& frame) { path->load(frame); });
+            steady.allocations += result.allocations;
+            steady.bytes += result.bytes;
+            steady.seconds += result.seconds;
+        }
+        report("after", first, steady, frames.size(), steadyPasses);
+    }
+    return 0;
+}
@@ -0,0 +1,234 @@
+// Throughput of the server message decoder.
+//
+// Runs protocol::decode over a set of recorded server messages in a loop, with
+// a handler that reads every record the way NetworkImpl does, and reports
+// messages/s and MiB/s for worldUpdate, chunkLoad and the whole mix.
+//
+//   decode-bench [--frames capture.bin] [--seconds 2] [--save capture.bin]
+//
+// A capture is a file of server messages, each prefixed with its length as a
+// little-endian u32. Without --frames a session is generated like mock-server
+// does: 16 players, worldUpdate ticks with 0 to 200 pixel updates, and chunkLoad
+// messages for a 32x32 chunk area. --save writes that generated set so it can
+// be edited or replaced by a real capture.
+
+#include <owop-client/Protocol.hpp>
+#include <owop-client/ProtocolDecoder.hpp>
+#include <owop-client/Wire.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace owop;
+using namespace owop::protocol;
+using Frame = std::vector<uint8_t>;
+
+struct Options {
+    std::string framesFile;
+    std::string saveFile;
+    double seconds = 2.0;  // Per measurement
+};
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        const char* value = argv[i + 1];
+
+        if (arg == "--frames") {
+            options.framesFile = value;
+        } else if (arg == "--save") {
+            options.saveFile = value;
+        } else if (arg == "--seconds") {
+            options.seconds = std::atof(value);
+        } else {
+            return false;
+        }
+    }
+    return argc % 2 == 1 && options.seconds > 0.0;
+}
+
+Frame makeWorldUpdate(std::mt19937& rng, size_t playerCount, size_t pixelCount) {
+    Frame frame(1 + 1 + playerCount * PlayerRecordLayout::SIZE + 2 + pixelCount * PixelRecordLayout::SIZE + 1);
+    uint8_t* out = frame.data();
+    *out++ = static_cast<uint8_t>(ServerCommand::WorldUpdate);
+
+    *out++ = static_cast<uint8_t>(playerCount);
+    for (size_t i = 0; i < playerCount; i++) {
+        PlayerRecordLayout::encode(out, static_cast<uint32_t>(i + 1),
+            static_cast<int32_t>(rng() % 4096) - 2048, static_cast<int32_t>(rng() % 4096) - 2048,
+            static_cast<uint8_t>(rng()), static_cast<uint8_t>(rng()), static_cast<uint8_t>(rng()), 0);
+        out += PlayerRecordLayout::SIZE;
+    }
+
+    wire::writeLE<uint16_t>(out, static_cast<uint16_t>(pixelCount));
+    out += 2;
+    for (size_t i = 0; i < pixelCount; i++) {
+        PixelRecordLayout::encode(out, static_cast<uint32_t>(rng() % playerCount + 1),
+            static_cast<int32_t>(rng() % 512) - 256, static_cast<int32_t>(rng() % 512) - 256,
+            static_cast<uint8_t>(rng()), static_cast<uint8_t>(rng()), static_cast<uint8_t>(rng()));
+        out += PixelRecordLayout::SIZE;
+    }
+
+    *out++ = 0;  // No disconnects
+    return frame;
+}
+
+Frame makeChunkLoad(int32_t x, int32_t y) {
+    Frame frame(CHUNK_MESSAGE_SIZE);
+    ChunkLoadHeaderLayout::encode(frame.data(), ChunkLoadHeaderLayout::OPCODE, x, y, 0);
+    for (size_t i = 0; i < CHUNK_PIXEL_BYTES; i++) {
+        frame[ChunkLoadHeaderLayout::SIZE + i] = static_cast<uint8_t>(x * 31 + y * 17 + i);
+    }
+    return frame;
+}
+
+std::vector<Frame> generateSession() {
+    std::mt19937 rng(1);
+    std::vector<Frame> frames;
+    for (int32_t y = -16; y < 16; y++) {
+        for (int32_t x = -16; x < 16; x++) {
+            frames.push_back(makeChunkLoad(x, y));
+            if ((x & 3) == 0) {
+                frames.push_back(makeWorldUpdate(rng, 16, rng() % 201));
+            }
+        }
+    }
+    return frames;
+}
+
+bool loadFrames(const std::string& path, std::vector<Frame>& frames) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    uint8_t prefix[4];
+    while (file.read(reinterpret_cast<char*>(prefix), sizeof(prefix))) {
+        Frame frame(wire::readLE<uint32_t>(prefix));
+        if (!file.read(reinterpret_cast<char*>(frame.data()), frame.size())) return false;
+        frames.push_back(std::move(frame));
+    }
+    return !frames.empty();
+}
+
+bool saveFrames(const std::string& path, const std::vector<Frame>& frames) {
+    std::ofstream file(path, std::ios::binary);
+    for (const auto& frame : frames) {
+        uint8_t prefix[4];
+        wire::writeLE<uint32_t>(prefix, static_cast<uint32_t>(frame.size()));
+        file.write(reinterpret_cast<const char*>(prefix), sizeof(prefix));
+        file.write(reinterpret_cast<const char*>(frame.data()), frame.size());
+    }
+    return static_cast<bool>(file);
+}
+
+// Reads what the client reads, and folds it into a checksum so none of it is optimized away
+class ConsumingHandler : public MessageHandler {
+public:
+    uint64_t checksum = 0;
+    uint64_t records = 0;
+
+    void onSetId(const SetIdMessage& msg) override { checksum += msg.id; }
+
+    void onWorldUpdate(const WorldUpdateMessage& msg) override {
+        for (const auto& player : msg.players) {
+            checksum += player.id ^ static_cast<uint32_t>(player.x) ^ static_cast<uint32_t>(player.y) ^ player.color.r;
+        }
+        for (const auto& pixel : msg.pixels) {
+            checksum += static_cast<uint32_t>(pixel.x) ^ static_cast<uint32_t>(pixel.y) ^ pixel.color.g ^ pixel.id;
+        }
+        for (uint32_t id : msg.disconnects) {
+            checksum += id;
+        }
+        records += msg.players.size() + msg.pixels.size() + msg.disconnects.size();
+    }
+
+    void onChunkLoad(const ChunkLoadMessage& msg) override {
+        // The client copies the pixels out; sample them rather than time a memcpy
+        checksum += static_cast<uint32_t>(msg.x) ^ static_cast<uint32_t>(msg.y) ^ msg.pixels.rgb[0] ^
+            msg.pixels.rgb[CHUNK_PIXEL_BYTES - 1];
+    }
+
+    void onTeleport(const TeleportMessage& msg) override { checksum += static_cast<uint32_t>(msg.x ^ msg.y); }
+    void onSetRank(const SetRankMessage& msg) override { checksum += msg.rank; }
+    void onCaptcha(const CaptchaMessage& msg) override { checksum += static_cast<uint8_t>(msg.state); }
+    void onSetPQuota(const SetPQuotaMessage& msg) override { checksum += msg.rate + msg.per; }
+    void onChunkProtected(const ChunkProtectedMessage& msg) override { checksum += msg.locked; }
+    void onMaxCount(const MaxCountMessage& msg) override { checksum += msg.maxPlayers; }
+    void onDonationUntil(const DonationUntilMessage& msg) override { checksum += msg.untilMs; }
+};
+
+void measure(const char* name, const std::vector<const Frame*>& frames, double seconds) {
+    if (frames.empty()) return;
+
+    using Clock = std::chrono::steady_clock;
+    ConsumingHandler handler;
+    uint64_t messages = 0;
+    uint64_t bytes = 0;
+    uint64_t failures = 0;
+
+    auto start = Clock::now();
+    auto deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    do {
+        for (const Frame* frame : frames) {
+            if (decode(frame->data(), frame->size(), handler) != DecodeResult::Ok) {
+                failures++;
+            }
+            bytes += frame->size();
+        }
+        messages += frames.size();
+    } while (Clock::now() < deadline);
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::printf("%-12s %8zu frames  %8.2f M msg/s  %8.1f MiB/s  %8.2f M records/s  (%llu rejected, checksum %llx)\n",
+        name, frames.size(), messages / elapsed / 1e6, bytes / elapsed / (1024.0 * 1024.0),
+        handler.records / elapsed / 1e6, static_cast<unsigned long long>(failures),
+        static_cast<unsigned long long>(handler.checksum));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "usage: decode-bench [--frames FILE] [--seconds N] [--save FILE]\n");
+        return 1;
+    }
+
+    std::vector<Frame> frames;
+    if (!options.framesFile.empty()) {
+        if (!loadFrames(options.framesFile, frames)) {
+            std::fprintf(stderr, "Could not read a capture from %s\n", options.framesFile.c_str());
+            return 1;
+        }
+    } else {
+        frames = generateSession();
+    }
+
+    if (!options.saveFile.empty() && !saveFrames(options.saveFile, frames)) {
+        std::fprintf(stderr, "Could not write %s\n", options.saveFile.c_str());
+        return 1;
+    }
+
+    std::vector<const Frame*> worldUpdates;
+    std::vector<const Frame*> chunkLoads;
+    std::vector<const Frame*> all;
+    for (const auto& frame : frames) {
+        if (frame.empty()) continue;
+        if (frame[0] == static_cast<uint8_t>(ServerCommand::WorldUpdate)) {
+            worldUpdates.push_back(&frame);
+        } else if (frame[0] == static_cast<uint8_t>(ServerCommand::ChunkLoad)) {
+            chunkLoads.push_back(&frame);
+        }
+        all.push_back(&frame);
+    }
+
+    measure("worldUpdate", worldUpdates, options.seconds);
+    measure("chunkLoad", chunkLoads, options.seconds);
+    measure("all", all, options.seconds);
+    return 0;
+}
@@ -0,0 +1,257 @@
+// Fuzz target for the server message decoder.
+//
+// Each input is copied into a buffer of exactly its length and decoded with a
+// handler that reads every record and pixel, so a read past the end shows up
+// under AddressSanitizer. The results are then checked against the lengths:
+// the handler runs exactly once for Ok and never otherwise, and an accepted
+// message is at least as long as everything the handler was given.
+//
+// Built as is, it runs a deterministic campaign: every truncation of a valid
+// message of each opcode, the same messages with trailing bytes, with count
+// fields larger than the data behind them, and with random byte changes.
+//
+//   decode-fuzz [--iterations 1000000] [--seed 1]
+//
+// Define OWOP_LIBFUZZER to build it as a libFuzzer target instead
+// (e.g. clang-cl /fsanitize=fuzzer,address).
+
+#include <owop-client/Protocol.hpp>
+#include <owop-client/ProtocolDecoder.hpp>
+#include <owop-client/Wire.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace owop;
+using namespace owop::protocol;
+using Frame = std::vector<uint8_t>;
+
+// Reads everything it is given and remembers how much that was
+class CheckingHandler : public MessageHandler {
+public:
+    int calls = 0;
+    size_t minLength = 0;  // Shortest message that could hold what was dispatched
+    uint32_t sink = 0;
+
+    void onSetId(const SetIdMessage& msg) override { dispatched(SetIdLayout::SIZE, msg.id); }
+
+    void onWorldUpdate(const WorldUpdateMessage& msg) override {
+        uint32_t sum = 0;
+        for (const auto& player : msg.players) sum += player.id + static_cast<uint32_t>(player.x) + player.tool;
+        for (const auto& pixel : msg.pixels) sum += pixel.id + static_cast<uint32_t>(pixel.y) + pixel.color.b;
+        for (uint32_t id : msg.disconnects) sum += id;
+
+        // Opcode and player count, then the sections up to the last non-empty one
+        size_t length = 2 + msg.players.size() * PlayerRecordLayout::SIZE;
+        if (!msg.pixels.empty() || !msg.disconnects.empty()) {
+            length += 2 + msg.pixels.size() * PixelRecordLayout::SIZE;
+        }
+        if (!msg.disconnects.empty()) {
+            length += 1 + msg.disconnects.size() * DisconnectRecordLayout::SIZE;
+        }
+        dispatched(length, sum);
+    }
+
+    void onChunkLoad(const ChunkLoadMessage& msg) override {
+        uint32_t sum = static_cast<uint32_t>(msg.x + msg.y);
+        for (size_t i = 0; i < CHUNK_PIXEL_BYTES; i++) sum += msg.pixels.rgb[i];
+        dispatched(CHUNK_MESSAGE_SIZE, sum);
+    }
+
+    void onTeleport(const TeleportMessage& msg) override { dispatched(TeleportLayout::SIZE, msg.x); }
+    void onSetRank(const SetRankMessage& msg) override { dispatched(SetRankLayout::SIZE, msg.rank); }
+    void onCaptcha(const CaptchaMessage& msg) override { dispatched(CaptchaLayout::SIZE, static_cast<uint8_t>(msg.state)); }
+    void onSetPQuota(const SetPQuotaMessage& msg) override { dispatched(SetPQuotaLayout::SIZE, msg.rate); }
+    void onChunkProtected(const ChunkProtectedMessage& msg) override { dispatched(ChunkProtectedLayout::SIZE, msg.locked); }
+    void onMaxCount(const MaxCountMessage& msg) override { dispatched(MaxCountLayout::SIZE, msg.maxPlayers); }
+    void onDonationUntil(const DonationUntilMessage& msg) override {
+        dispatched(DonationUntilLayout::SIZE, static_cast<uint32_t>(msg.untilMs));
+    }
+
+private:
+    void dispatched(size_t length, uint32_t value) {
+        calls++;
+        minLength = length;
+        sink += value;
+    }
+};
+
+// Decode one input; returns an error description, or nullptr if it behaved
+const char* fuzzOne(const uint8_t* data, size_t size) {
+    // Exactly sized, so reading one byte too far is a heap overflow
+    Frame input(data, data + size);
+    CheckingHandler handler;
+    DecodeResult result = decode(input.data(), input.size(), handler);
+
+    if (result == DecodeResult::Ok) {
+        if (handler.calls != 1) return "Ok without exactly one handler call";
+        if (handler.minLength > size) return "Ok for a message shorter than what was dispatched";
+    } else if (handler.calls != 0) {
+        return "handler called for a rejected message";
+    }
+    if (size == 0 && result != DecodeResult::Empty) return "empty message not reported as Empty";
+    return nullptr;
+}
+
+// One valid message of every opcode
+std::vector<Frame> makeSeeds() {
+    std::vector<Frame> seeds;
+    auto add = [&seeds](const uint8_t* data, size_t size) { seeds.emplace_back(data, data + size); };
+
+    add(SetIdLayout::make(7).data(), SetIdLayout::SIZE);
+    add(TeleportLayout::make(-100, 200).data(), TeleportLayout::SIZE);
+    add(SetRankLayout::make(2).data(), SetRankLayout::SIZE);
+    add(CaptchaLayout::make(static_cast<uint8_t>(CaptchaState::Ok)).data(), CaptchaLayout::SIZE);
+    add(SetPQuotaLayout::make(32, 4).data(), SetPQuotaLayout::SIZE);
+    add(ChunkProtectedLayout::make(3, -4, 1).data(), ChunkProtectedLayout::SIZE);
+    add(MaxCountLayout::make(64).data(), MaxCountLayout::SIZE);
+    add(DonationUntilLayout::make(1700000000000ull, 1.5f).data(), DonationUntilLayout::SIZE);
+
+    Frame chunk(CHUNK_MESSAGE_SIZE, 0x5a);
+    ChunkLoadHeaderLayout::encode(chunk.data(), ChunkLoadHeaderLayout::OPCODE, -1, 2, 0);
+    seeds.push_back(chunk);
+
+    // worldUpdate with 2 players, 3 pixels and 1 disconnect
+    Frame update(1 + 1 + 2 * PlayerRecordLayout::SIZE + 2 + 3 * PixelRecordLayout::SIZE + 1 + DisconnectRecordLayout::SIZE);
+    uint8_t* out = update.data();
+    *out++ = static_cast<uint8_t>(ServerCommand::WorldUpdate);
+    *out++ = 2;
+    for (uint32_t i = 0; i < 2; i++, out += PlayerRecordLayout::SIZE) {
+        PlayerRecordLayout::encode(out, i + 1, 10, -10, 1, 2, 3, 0);
+    }
+    wire::writeLE<uint16_t>(out, 3);
+    out += 2;
+    for (uint32_t i = 0; i < 3; i++, out += PixelRecordLayout::SIZE) {
+        PixelRecordLayout::encode(out, 1, static_cast<int32_t>(i), -5, 255, 0, 0);
+    }
+    *out++ = 1;
+    DisconnectRecordLayout::encode(out, 2);
+    seeds.push_back(update);
+    return seeds;
+}
+
+class Campaign {
+public:
+    explicit Campaign(uint32_t seed) : rng(seed) {}
+
+    void run(const Frame& input, const char* kind) {
+        runs++;
+        const char* error = fuzzOne(input.data(), input.size());
+        if (!error) return;
+
+        failures++;
+        if (failures <= 20) {
+            std::printf("FAIL %s: %s (opcode %d, %zu bytes)\n", kind, error, input.empty() ? -1 : input[0], input.size());
+        }
+    }
+
+    void truncations(const Frame& seed) {
+        for (size_t length = 0; length <= seed.size(); length++) {
+            run(Frame(seed.begin(), seed.begin() + length), "truncated");
+        }
+    }
+
+    void oversized(const Frame& seed) {
+        for (size_t extra : {1, 2, 3, 15, 16, 4096}) {
+            Frame input = seed;
+            for (size_t i = 0; i < extra; i++) input.push_back(static_cast<uint8_t>(rng()));
+            run(input, "oversized");
+        }
+    }
+
+    // worldUpdate counts claiming more records than follow, at every truncation
+    void inflatedCounts(const Frame& seed) {
+        if (seed[0] != static_cast<uint8_t>(ServerCommand::WorldUpdate)) return;
+
+        size_t pixelCountOffset = 2 + seed[1] * PlayerRecordLayout::SIZE;
+        size_t disconnectCountOffset = pixelCountOffset + 2 + wire::readLE<uint16_t>(seed.data() + pixelCountOffset) * PixelRecordLayout::SIZE;
+        for (int field = 0; field < 3; field++) {
+            Frame input = seed;
+            if (field == 0) input[1] = 0xff;
+            if (field == 1) wire::writeLE<uint16_t>(input.data() + pixelCountOffset, 0xffff);
+            if (field == 2) input[disconnectCountOffset] = 0xff;
+            truncations(input);
+        }
+    }
+
+    void mutations(const Frame& seed, int count) {
+        for (int i = 0; i < count; i++) {
+            Frame input = seed;
+            int changes = 1 + static_cast<int>(rng() % 4);
+            for (int c = 0; c < changes && !input.empty(); c++) {
+                switch (rng() % 3) {
+                    case 0: input[rng() % input.size()] = static_cast<uint8_t>(rng()); break;
+                    case 1: input.resize(rng() % (input.size() + 1)); break;
+                    case 2: input.insert(input.begin() + rng() % (input.size() + 1), static_cast<uint8_t>(rng())); break;
+                }
+            }
+            run(input, "mutated");
+        }
+    }
+
+    uint64_t runs = 0;
+    uint64_t failures = 0;
+
+private:
+    std::mt19937 rng;
+};
+
+} // namespace
+
+#ifdef OWOP_LIBFUZZER
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (const char* error = fuzzOne(data, size)) {
+        std::fprintf(stderr, "decode-fuzz: %s\n", error);
+        std::abort();
+    }
+    return 0;
+}
+
+#else
+
+int main(int argc, char** argv) {
+    long iterations = 1000000;
+    uint32_t seed = 1;
+    bool valid = argc % 2 == 1;
+    for (int i = 1; valid && i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--iterations") {
+            iterations = std::atol(argv[i + 1]);
+        } else if (arg == "--seed") {
+            seed = static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid || iterations < 0) {
+        std::fprintf(stderr, "usage: decode-fuzz [--iterations N] [--seed N]\n");
+        return 1;
+    }
+
+    std::vector<Frame> seeds = makeSeeds();
+    Campaign campaign(seed);
+    for (const auto& input : seeds) {
+        campaign.truncations(input);
+        campaign.oversized(input);
+        campaign.inflatedCounts(input);
+    }
+    for (const auto& input : seeds) {
+        campaign.mutations(input, static_cast<int>(iterations / static_cast<long>(seeds.size())));
+    }
+
+    // Every opcode byte, including ones the protocol doesn't have, on its own
+    for (int opcode = 0; opcode < 256; opcode++) {
+        campaign.run(Frame{static_cast<uint8_t>(opcode)}, "opcode");
+    }
+
+    std::printf("%llu inputs, %llu failures\n", static_cast<unsigned long long>(campaign.runs),
+        static_cast<unsigned long long>(campaign.failures));
+    return campaign.failures == 0 ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,464 @@
+// Loopback OWOP server for load testing the client.
+//
+// Speaks the same binary protocol as the real server: captcha states, setId,
+// setPQuota, chunkLoad for a synthetic (or recorded) world, and worldUpdate
+// ticks carrying bot cursors and random pixel updates at a configurable rate.
+// Pixels placed by clients are applied and echoed back like the real server does.
+//
+//   mock-server [--port 9000] [--cert server.pem --key server.key]
+//               [--tick-ms 50] [--pixel-rate 1000] [--bots 16]
+//               [--quota-rate 32 --quota-per 4] [--chunk-delay-ms 0]
+//               [--drop-rate 0.0] [--captcha] [--deflate] [--world-file chunks.bin] [--seed 1]
+//
+// Without --cert/--key the server speaks plain ws://, with them wss://.
+// --deflate accepts permessage-deflate and compresses everything it sends to
+// clients that negotiated it.
+// --world-file is a file of back-to-back chunkLoad messages (778 bytes each);
+// chunks missing from it are generated from their coordinates.
+
+#include <owop-client/Protocol.hpp>
+#include <owop-client/Logger.hpp>
+#include <websocketpp/config/asio.hpp>
+#include <websocketpp/server.hpp>
+#include <websocketpp/extensions/permessage_deflate/enabled.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using namespace owop;
+using namespace owop::protocol;
+
+struct Options {
+    uint16_t port = 9000;
+    std::string certFile;
+    std::string keyFile;
+    int tickMs = 50;             // worldUpdate interval
+    int pixelRate = 1000;        // Random pixel updates per second, per client
+    int bots = 16;               // Fake players moving around the origin
+    uint16_t quotaRate = 32;
+    uint16_t quotaPer = 4;
+    int chunkDelayMs = 0;        // Extra delay before answering a chunk request
+    double dropRate = 0.0;       // Fraction of chunk requests left unanswered
+    bool captcha = false;        // Ask for a captcha token before letting clients in
+    bool deflate = false;        // Negotiate permessage-deflate and compress outgoing messages
+    std::string worldFile;
+    uint32_t seed = 1;
+};
+
+using ChunkPixels = std::array<uint8_t, CHUNK_PIXEL_BYTES>;
+
+uint64_t chunkKey(int32_t x, int32_t y) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+}
+
+// Chunks the server has sent or modified, generated on first use
+class World {
+public:
+    bool loadFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+
+        std::array<uint8_t, CHUNK_MESSAGE_SIZE> message;
+        while (file.read(reinterpret_cast<char*>(message.data()), message.size())) {
+            if (message[0] != ChunkLoadHeaderLayout::OPCODE) continue;
+            auto& pixels = chunks[chunkKey(ChunkLoadHeaderLayout::field<0>(message.data()),
+                                           ChunkLoadHeaderLayout::field<1>(message.data()))];
+            std::memcpy(pixels.data(), message.data() + ChunkLoadHeaderLayout::SIZE, CHUNK_PIXEL_BYTES);
+        }
+        Logger::info("MockServer", "Loaded " + std::to_string(chunks.size()) + " chunks from " + path);
+        return true;
+    }
+
+    ChunkPixels& getChunk(int32_t x, int32_t y) {
+        auto inserted = chunks.emplace(chunkKey(x, y), ChunkPixels{});
+        if (inserted.second) {
+            generate(x, y, inserted.first->second);
+        }
+        return inserted.first->second;
+    }
+
+    void setPixel(int32_t x, int32_t y, const Color& color) {
+        int32_t chunkX = floorDiv(x, CHUNK_SIZE);
+        int32_t chunkY = floorDiv(y, CHUNK_SIZE);
+        auto& pixels = getChunk(chunkX, chunkY);
+        size_t offset = ((y - chunkY * CHUNK_SIZE) * CHUNK_SIZE + (x - chunkX * CHUNK_SIZE)) * sizeof(Color);
+        pixels[offset] = color.r;
+        pixels[offset + 1] = color.g;
+        pixels[offset + 2] = color.b;
+    }
+
+private:
+    // Deterministic pattern so runs are comparable: a gradient per chunk plus a grid
+    static void generate(int32_t chunkX, int32_t chunkY, ChunkPixels& pixels) {
+        uint32_t hash = static_cast<uint32_t>(chunkX) * 73856093u ^ static_cast<uint32_t>(chunkY) * 19349663u;
+        for (int y = 0; y < CHUNK_SIZE; y++) {
+            for (int x = 0; x < CHUNK_SIZE; x++) {
+                size_t offset = (y * CHUNK_SIZE + x) * sizeof(Color);
+                bool grid = x == 0 || y == 0;
+                pixels[offset] = grid ? 200 : static_cast<uint8_t>(hash + x * 8);
+                pixels[offset + 1] = grid ? 200 : static_cast<uint8_t>((hash >> 8) + y * 8);
+                pixels[offset + 2] = grid ? 200 : static_cast<uint8_t>(hash >> 16);
+            }
+        }
+    }
+
+    std::unordered_map<uint64_t, ChunkPixels> chunks;
+};
+
+struct Bot {
+    uint32_t id;
+    float angle;
+    float radius;
+    Color color;
+};
+
+template<typename Config>
+class MockServer {
+public:
+    using Server = websocketpp::server<Config>;
+    using Handle = websocketpp::connection_hdl;
+
+    MockServer(const Options& options)
+        : options(options)
+        , rng(options.seed)
+    {
+        server.clear_access_channels(websocketpp::log::alevel::all);
+        server.clear_error_channels(websocketpp::log::elevel::all);
+        server.set_error_channels(websocketpp::log::elevel::fatal);
+        server.init_asio(&io);
+        server.set_reuse_addr(true);
+
+        server.set_open_handler([this](Handle hdl) { onOpen(hdl); });
+        server.set_close_handler([this](Handle hdl) { onClose(hdl); });
+        server.set_message_handler([this](Handle hdl, typename Server::message_ptr msg) { onMessage(hdl, msg); });
+
+        for (int i = 0; i < options.bots; i++) {
+            std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+            bots.push_back(Bot{nextId++, unit(rng) * 6.2832f, 64.0f + unit(rng) * 512.0f,
+                Color(static_cast<uint8_t>(rng()), static_cast<uint8_t>(rng()), static_cast<uint8_t>(rng()))});
+        }
+
+        if (!options.worldFile.empty() && !world.loadFile(options.worldFile)) {
+            Logger::error("MockServer", "Could not read " + options.worldFile + ", using a synthetic world");
+        }
+    }
+
+    Server& getServer() { return server; }
+
+    void run() {
+        server.listen(options.port);
+        server.start_accept();
+        Logger::info("MockServer", "Listening on port " + std::to_string(options.port));
+        scheduleTick();
+        io.run();
+    }
+
+private:
+    struct Session {
+        uint32_t id = 0;
+        bool joined = false;
+        int32_t cursorX = 0;  // 1/16 pixel units
+        int32_t cursorY = 0;
+        std::vector<uint64_t> requestedChunks;  // Where random pixel updates land
+        double pixelCredit = 0.0;
+        uint64_t chunksSent = 0;
+        uint64_t pixelsSent = 0;
+        std::chrono::steady_clock::time_point openedAt;
+    };
+
+    void send(Handle hdl, const uint8_t* data, size_t length) {
+        websocketpp::lib::error_code ec;
+        if (!options.deflate) {
+            server.send(hdl, data, length, websocketpp::frame::opcode::binary, ec);
+            return;
+        }
+
+        // Only flagged messages are compressed, and only once the client negotiated the extension
+        auto msg = std::make_shared<typename Config::message_type>(nullptr, websocketpp::frame::opcode::binary, length);
+        msg->append_payload(data, length);
+        msg->set_compressed(true);
+        server.send(hdl, msg, ec);
+    }
+
+    template<size_t N>
+    void send(Handle hdl, const std::array<uint8_t, N>& message) {
+        send(hdl, message.data(), message.size());
+    }
+
+    void onOpen(Handle hdl) {
+        Session& session = sessions[hdl];
+        session.id = nextId++;
+        session.openedAt = std::chrono::steady_clock::now();
+
+        auto state = options.captcha ? CaptchaState::Waiting : CaptchaState::Ok;
+        send(hdl, CaptchaLayout::make(static_cast<uint8_t>(state)));
+        Logger::info("MockServer", "Client " + std::to_string(session.id) + " connected");
+    }
+
+    void onClose(Handle hdl) {
+        auto it = sessions.find(hdl);
+        if (it == sessions.end()) return;
+
+        const Session& session = it->second;
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - session.openedAt).count();
+        Logger::info("MockServer", "Client " + std::to_string(session.id) + " left after " +
+            std::to_string(seconds) + "s: " + std::to_string(session.chunksSent) + " chunks, " +
+            std::to_string(session.pixelsSent) + " pixel updates");
+        sessions.erase(it);
+    }
+
+    void onMessage(Handle hdl, typename Server::message_ptr msg) {
+        auto it = sessions.find(hdl);
+        if (it == sessions.end()) return;
+        Session& session = it->second;
+
+        const std::string& payload = msg->get_payload();
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(payload.data());
+        size_t length = payload.size();
+
+        if (msg->get_opcode() == websocketpp::frame::opcode::text) {
+            // Any token is accepted
+            if (payload.compare(0, 7, "CaptchA") == 0) {
+                send(hdl, CaptchaLayout::make(static_cast<uint8_t>(CaptchaState::Ok)));
+            }
+            return;
+        }
+
+        if (!session.joined) {
+            // World name followed by the 25565 verification value
+            if (length >= 2 && data[length - 2] == 0xDD && data[length - 1] == 0x63) {
+                session.joined = true;
+                send(hdl, SetIdLayout::make(session.id));
+                send(hdl, SetPQuotaLayout::make(options.quotaRate, options.quotaPer));
+            }
+            return;
+        }
+
+        if (length == ChunkRequestLayout::SIZE && data[0] == ChunkRequestLayout::OPCODE) {
+            onChunkRequest(hdl, session, ChunkRequestLayout::field<0>(data), ChunkRequestLayout::field<1>(data));
+        } else if (length == PixelLayout::SIZE && data[0] == PixelLayout::OPCODE) {
+            Color color(PixelLayout::field<2>(data), PixelLayout::field<3>(data), PixelLayout::field<4>(data));
+            world.setPixel(PixelLayout::field<0>(data), PixelLayout::field<1>(data), color);
+            placedPixels.push_back(PixelUpdate{PixelLayout::field<0>(data), PixelLayout::field<1>(data), color, session.id});
+        } else if (length == MoveLayout::SIZE && data[0] == MoveLayout::OPCODE) {
+            session.cursorX = MoveLayout::field<0>(data);
+            session.cursorY = MoveLayout::field<1>(data);
+        }
+    }
+
+    void onChunkRequest(Handle hdl, Session& session, int32_t x, int32_t y) {
+        if (options.dropRate > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(rng) < options.dropRate) {
+            return;
+        }
+
+        session.requestedChunks.push_back(chunkKey(x, y));
+
+        if (options.chunkDelayMs <= 0) {
+            sendChunk(hdl, x, y);
+            return;
+        }
+
+        auto timer = std::make_shared<boost::asio::steady_timer>(io, std::chrono::milliseconds(options.chunkDelayMs));
+        timer->async_wait([this, hdl, x, y, timer](const boost::system::error_code& ec) {
+            if (!ec) sendChunk(hdl, x, y);
+        });
+    }
+
+    void sendChunk(Handle hdl, int32_t x, int32_t y) {
+        auto it = sessions.find(hdl);
+        if (it == sessions.end()) return;
+
+        std::array<uint8_t, CHUNK_MESSAGE_SIZE> message;
+        ChunkLoadHeaderLayout::encode(message.data(), ChunkLoadHeaderLayout::OPCODE, x, y, 0);
+        std::memcpy(message.data() + ChunkLoadHeaderLayout::SIZE, world.getChunk(x, y).data(), CHUNK_PIXEL_BYTES);
+        send(hdl, message);
+        it->second.chunksSent++;
+    }
+
+    void scheduleTick() {
+        tickTimer.expires_after(std::chrono::milliseconds(options.tickMs));
+        tickTimer.async_wait([this](const boost::system::error_code& ec) {
+            if (ec) return;
+            tick();
+            scheduleTick();
+        });
+    }
+
+    // One worldUpdate per client: bot cursors, pixels placed by clients, and random pixels
+    void tick() {
+        for (auto& bot : bots) {
+            bot.angle += 0.05f;
+        }
+
+        for (auto& pair : sessions) {
+            Session& session = pair.second;
+            if (!session.joined) continue;
+
+            session.pixelCredit += options.pixelRate * options.tickMs / 1000.0;
+            size_t randomPixels = session.requestedChunks.empty() ? 0 : static_cast<size_t>(session.pixelCredit);
+            session.pixelCredit -= static_cast<double>(randomPixels);
+
+            size_t pixelCount = std::min<size_t>(placedPixels.size() + randomPixels, UINT16_MAX);
+            size_t playerCount = std::min<size_t>(bots.size(), UINT8_MAX);
+
+            message.resize(1 + 1 + playerCount * PlayerRecordLayout::SIZE + 2 + pixelCount * PixelRecordLayout::SIZE + 1);
+            uint8_t* out = message.data();
+            *out++ = static_cast<uint8_t>(ServerCommand::WorldUpdate);
+
+            *out++ = static_cast<uint8_t>(playerCount);
+            for (size_t i = 0; i < playerCount; i++) {
+                const Bot& bot = bots[i];
+                PlayerRecordLayout::encode(out, bot.id,
+                    static_cast<int32_t>(std::cos(bot.angle) * bot.radius * PLAYER_POSITION_SCALE),
+                    static_cast<int32_t>(std::sin(bot.angle) * bot.radius * PLAYER_POSITION_SCALE),
+                    bot.color.r, bot.color.g, bot.color.b, 0);
+                out += PlayerRecordLayout::SIZE;
+            }
+
+            wire::writeLE<uint16_t>(out, static_cast<uint16_t>(pixelCount));
+            out += 2;
+            for (size_t i = 0; i < pixelCount; i++) {
+                PixelUpdate update;
+                if (i < placedPixels.size()) {
+                    update = placedPixels[i];
+                } else {
+                    uint64_t key = session.requestedChunks[rng() % session.requestedChunks.size()];
+                    update.x = static_cast<int32_t>(static_cast<uint32_t>(key >> 32)) * CHUNK_SIZE + static_cast<int32_t>(rng() % CHUNK_SIZE);
+                    update.y = static_cast<int32_t>(static_cast<uint32_t>(key)) * CHUNK_SIZE + static_cast<int32_t>(rng() % CHUNK_SIZE);
+                    update.color = Color(static_cast<uint8_t>(rng()), static_cast<uint8_t>(rng()), static_cast<uint8_t>(rng()));
+                    update.id = bots.empty() ? 0 : bots[rng() % bots.size()].id;
+                    world.setPixel(update.x, update.y, update.color);
+                }
+                PixelRecordLayout::encode(out, update.id, update.x, update.y, update.color.r, update.color.g, update.color.b);
+                out += PixelRecordLayout::SIZE;
+            }
+
+            *out++ = 0;  // No disconnects
+            send(pair.first, message.data(), message.size());
+            session.pixelsSent += pixelCount;
+        }
+
+        placedPixels.clear();
+    }
+
+    Options options;
+    boost::asio::io_context io;
+    boost::asio::steady_timer tickTimer{io};
+    Server server;
+    World world;
+    std::mt19937 rng;
+    std::map<Handle, Session, std::owner_less<Handle>> sessions;
+    std::vector<Bot> bots;
+    std::vector<PixelUpdate> placedPixels;  // Echoed to everyone on the next tick
+    std::vector<uint8_t> message;           // Reused worldUpdate buffer
+    uint32_t nextId = 1;
+};
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--captcha") {
+            options.captcha = true;
+        } else if (arg == "--deflate") {
+            options.deflate = true;
+        } else if (!hasValue) {
+            return false;
+        } else if (arg == "--port") {
+            options.port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        } else if (arg == "--cert") {
+            options.certFile = argv[++i];
+        } else if (arg == "--key") {
+            options.keyFile = argv[++i];
+        } else if (arg == "--tick-ms") {
+            options.tickMs = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--pixel-rate") {
+            options.pixelRate = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--bots") {
+            options.bots = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--quota-rate") {
+            options.quotaRate = static_cast<uint16_t>(std::atoi(argv[++i]));
+        } else if (arg == "--quota-per") {
+            options.quotaPer = static_cast<uint16_t>(std::atoi(argv[++i]));
+        } else if (arg == "--chunk-delay-ms") {
+            options.chunkDelayMs = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--drop-rate") {
+            options.dropRate = std::atof(argv[++i]);
+        } else if (arg == "--world-file") {
+            options.worldFile = argv[++i];
+        } else if (arg == "--seed") {
+            options.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            return false;
+        }
+    }
+    return options.certFile.empty() == options.keyFile.empty();
+}
+
+struct DeflateConfig : websocketpp::config::asio {
+    typedef DeflateConfig type;
+    struct permessage_deflate_config {};
+    typedef websocketpp::extensions::permessage_deflate::enabled<permessage_deflate_config> permessage_deflate_type;
+};
+
+struct DeflateTlsConfig : websocketpp::config::asio_tls {
+    typedef DeflateTlsConfig type;
+    struct permessage_deflate_config {};
+    typedef websocketpp::extensions::permessage_deflate::enabled<permessage_deflate_config> permessage_deflate_type;
+};
+
+template<typename Config>
+void runServer(const Options& options) {
+    MockServer<Config> server(options);
+    server.run();
+}
+
+template<typename Config>
+void runTlsServer(const Options& options) {
+    MockServer<Config> server(options);
+    server.getServer().set_tls_init_handler([&options](websocketpp::connection_hdl) {
+        auto ctx = websocketpp::lib::make_shared<boost::asio::ssl::context>(boost::asio::ssl::context::tlsv12);
+        ctx->use_certificate_chain_file(options.certFile);
+        ctx->use_private_key_file(options.keyFile, boost::asio::ssl::context::pem);
+        return ctx;
+    });
+    server.run();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: mock-server [--port N] [--cert FILE --key FILE] [--tick-ms N] [--pixel-rate N]\n"
+                     "                   [--bots N] [--quota-rate N] [--quota-per N] [--chunk-delay-ms N]\n"
+                     "                   [--drop-rate F] [--captcha] [--deflate] [--world-file FILE] [--seed N]\n";
+        return 1;
+    }
+
+    try {
+        if (options.certFile.empty()) {
+            options.deflate ? runServer<DeflateConfig>(options) : runServer<websocketpp::config::asio>(options);
+        } else {
+            options.deflate ? runTlsServer<DeflateTlsConfig>(options) : runTlsServer<websocketpp::config::asio_tls>(options);
+        }
+    } catch (const std::exception& e) {
+        owop::Logger::error("MockServer", e.what());
+        return 1;
+    }
+    return 0;
+}
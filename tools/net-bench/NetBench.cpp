@@ -0,0 +1,202 @@
+// Headless end-to-end benchmark of the client networking stack.
+//
+// Drives owop::Network the way the client's main loop does - one
+// dispatchEvents() per simulated frame - against a server (normally
+// tools/mock-server on loopback), pans the view to keep chunks flowing, places
+// pixels at a fixed rate, and reports chunk throughput, pixel update throughput,
+// chunk RTT, pixel placement-to-echo latency and received bytes with and
+// without permessage-deflate (start mock-server with --deflate to compare).
+//
+//   net-bench [--url ws://127.0.0.1:9000] [--world main] [--seconds 10]
+//             [--view 1920x1080] [--zoom 4] [--pan-ms 1000] [--place-rate 8]
+//             [--deflate on|off]
+
+#include <owop-client/Network.hpp>
+#include <owop-client/PendingPixelWrites.hpp>
+#include <owop-client/Logger.hpp>
+#include <owop-client/Settings.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+struct Options {
+    std::string url = "ws://127.0.0.1:9000";
+    std::string world = "main";
+    int seconds = 10;
+    int viewWidth = 1920;
+    int viewHeight = 1080;
+    float zoom = 4.0f;
+    int panMs = 1000;     // Move the view by one screen this often; 0 keeps it still
+    int placeRate = 8;    // Pixels placed per second
+    bool deflate = true;  // Offer permessage-deflate
+};
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        const char* value = argv[i + 1];
+
+        if (arg == "--url") {
+            options.url = value;
+        } else if (arg == "--world") {
+            options.world = value;
+        } else if (arg == "--seconds") {
+            options.seconds = std::atoi(value);
+        } else if (arg == "--view") {
+            if (std::sscanf(value, "%dx%d", &options.viewWidth, &options.viewHeight) != 2) return false;
+        } else if (arg == "--zoom") {
+            options.zoom = static_cast<float>(std::atof(value));
+        } else if (arg == "--pan-ms") {
+            options.panMs = std::atoi(value);
+        } else if (arg == "--place-rate") {
+            options.placeRate = std::atoi(value);
+        } else if (arg == "--deflate") {
+            options.deflate = std::string(value) != "off";
+        } else {
+            return false;
+        }
+    }
+    return argc % 2 == 1 && options.seconds > 0 && options.zoom > 0.0f;
+}
+
+uint64_t pixelKey(int32_t x, int32_t y) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using Clock = std::chrono::steady_clock;
+
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "usage: net-bench [--url URL] [--world NAME] [--seconds N] [--view WxH]\n"
+                             "                 [--zoom Z] [--pan-ms N] [--place-rate N] [--deflate on|off]\n");
+        return 1;
+    }
+
+    owop::Settings::getInstance().compressTraffic = options.deflate;
+
+    owop::Network network;
+    uint64_t chunks = 0;
+    uint64_t pixelUpdates = 0;
+    std::unordered_map<uint64_t, Clock::time_point> placedAt;
+    owop::LatencyHistogram echoLatency;
+
+    network.setChunkDataCallback([&](int, int, owop::ChunkPixels&) {
+        chunks++;
+    });
+
+    network.setPixelBatchCallback([&](const owop::PixelBatch& batch) {
+        pixelUpdates += batch.pixels.size();
+        if (placedAt.empty()) return;
+
+        uint32_t ourId = network.getPlayerId();
+        auto now = Clock::now();
+        for (const auto& entry : batch.pixels) {
+            if (entry.playerId != ourId) continue;
+            auto it = placedAt.find(pixelKey(batch.chunkX * owop::CHUNK_SIZE + entry.index % owop::CHUNK_SIZE,
+                                             batch.chunkY * owop::CHUNK_SIZE + entry.index / owop::CHUNK_SIZE));
+            if (it == placedAt.end()) continue;
+            echoLatency.record(std::chrono::duration<double, std::milli>(now - it->second).count());
+            placedAt.erase(it);
+        }
+    });
+
+    network.connect(options.url, options.world);
+
+    // Wait for the world join before starting the clock
+    auto joinDeadline = Clock::now() + std::chrono::seconds(10);
+    while (network.getPlayerId() == 0 && Clock::now() < joinDeadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (network.getPlayerId() == 0) {
+        owop::Logger::error("NetBench", "Did not join " + options.world + " on " + options.url);
+        return 1;
+    }
+
+    int32_t centerX = 0;
+    int32_t centerY = 0;
+    network.requestChunksInView(centerX, centerY, options.zoom, options.viewWidth, options.viewHeight);
+
+    auto start = Clock::now();
+    auto end = start + std::chrono::seconds(options.seconds);
+    auto nextPan = start + std::chrono::milliseconds(options.panMs);
+    double placeCredit = 0.0;
+    int32_t placeIndex = 0;
+    auto lastFrame = start;
+
+    // ~60 fps, like the client's vsynced main loop
+    for (auto now = start; now < end; now = Clock::now()) {
+        network.dispatchEvents();
+
+        if (options.panMs > 0 && now >= nextPan) {
+            centerX += static_cast<int32_t>(options.viewWidth / options.zoom);
+            network.requestChunksInView(centerX, centerY, options.zoom, options.viewWidth, options.viewHeight);
+            nextPan += std::chrono::milliseconds(options.panMs);
+        }
+
+        // Place pixels inside the loaded area around the view center
+        placeCredit += options.placeRate * std::chrono::duration<double>(now - lastFrame).count();
+        lastFrame = now;
+        while (placeCredit >= 1.0) {
+            int32_t x = centerX + placeIndex % 64;
+            int32_t y = centerY + (placeIndex / 64) % 64;
+            owop::Color color(static_cast<uint8_t>(placeIndex), static_cast<uint8_t>(placeIndex >> 8), 0x80);
+            if (network.placePixel(x, y, color)) {
+                placedAt[pixelKey(x, y)] = now;
+            }
+            placeIndex++;
+            placeCredit -= 1.0;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(16));
+    }
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    auto pipeline = network.getChunkPipelineStats();
+    auto queue = network.getEventQueueStats();
+    auto pixels = network.getPixelWriteStats();
+    auto compression = network.getCompressionStats();
+    auto send = network.getSendStats();
+    auto connection = network.getConnectionStats();
+
+    std::printf("elapsed            %.2f s\n", elapsed);
+    std::printf("session            connect %.1f ms, captcha %.1f ms, join %.1f ms\n",
+        connection.phaseMs[static_cast<size_t>(owop::SessionState::Connecting)],
+        connection.phaseMs[static_cast<size_t>(owop::SessionState::Captcha)],
+        connection.phaseMs[static_cast<size_t>(owop::SessionState::Joining)]);
+    std::printf("chunks             %llu (%.1f/s)\n", static_cast<unsigned long long>(chunks), chunks / elapsed);
+    std::printf("pixel updates      %llu (%.1f/s)\n", static_cast<unsigned long long>(pixelUpdates), pixelUpdates / elapsed);
+    std::printf("chunk rtt          %.1f ms smoothed, %.1f ms min\n", pipeline.smoothedRttMs, pipeline.minRttMs);
+    std::printf("chunk timeouts     %llu (retries %llu, abandoned %llu)\n",
+        static_cast<unsigned long long>(pipeline.timeouts),
+        static_cast<unsigned long long>(pipeline.retries),
+        static_cast<unsigned long long>(pipeline.abandoned));
+    std::printf("pixels placed      %llu sent, %llu echoed, %zu still queued\n",
+        static_cast<unsigned long long>(pixels.sent),
+        static_cast<unsigned long long>(echoLatency.count), pixels.pending);
+    std::printf("echo latency       p50 < %.0f ms, p99 < %.0f ms\n",
+        echoLatency.percentile(0.5), echoLatency.percentile(0.99));
+    std::printf("received           %.1f KiB wire, %.1f KiB payload, deflate %s, %.1f ms inflating\n",
+        compression.wireBytes / 1024.0, compression.payloadBytes / 1024.0,
+        compression.negotiated ? "on" : "off", compression.inflateMs);
+    std::printf("send buffer        peak %zu bytes, %llu flushes, %llu stalls\n", send.peakBufferedBytes,
+        static_cast<unsigned long long>(send.flushes), static_cast<unsigned long long>(send.stalls));
+    for (size_t i = 0; i < owop::SEND_LANE_COUNT; i++) {
+        const auto& lane = send.lanes[i];
+        std::printf("  %-16s %llu sent, peak %zu queued, wait %.2f ms avg %.1f ms max\n",
+            owop::toString(static_cast<owop::SendLane>(i)), static_cast<unsigned long long>(lane.sent),
+            lane.peakQueuedFrames, lane.avgWaitMs, lane.maxWaitMs);
+    }
+    std::printf("event queue        peak %zu / %zu, %llu overflows\n", queue.peakDepth, queue.capacity,
+        static_cast<unsigned long long>(queue.overflows));
+
+    network.disconnect();
+    return 0;
+}